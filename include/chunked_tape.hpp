@@ -0,0 +1,140 @@
+#ifndef CHUNKED_TAPE_HPP
+#define CHUNKED_TAPE_HPP
+
+#include <vector>
+#include <array>
+#include <memory>
+#include <atomic>
+#include <span>
+#include <compare>
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <cstddef>
+
+// Tape made of reference counted fixed size chunks
+// Copies share every chunk, a chunk is only copied on the first write to it while shared (copy-on-write)
+// This makes copying a tape O(number of chunks) rather than O(number of cells)
+// Copies may be used on different threads, but a single tape is not synchronised
+template <typename T, std::size_t chunkSize = 4096>
+	requires(std::has_single_bit(chunkSize))
+class ChunkedTape {
+	using Chunk = std::array<T, chunkSize>;
+
+	std::vector<std::shared_ptr<Chunk>> chunks_;
+	std::size_t size_ = 0;
+
+	Chunk& unique_chunk(std::size_t chunk) {
+		auto& ptr = chunks_[chunk];
+		if (ptr.use_count() > 1)
+			ptr = std::make_shared<Chunk>(*ptr);
+		else {
+			// use_count is a relaxed load, a tape on another thread may have read this chunk just before dropping its reference
+			// The reference count decrement is a release, so this fence orders our writes after those reads
+			std::atomic_thread_fence(std::memory_order_acquire);
+		}
+		return *ptr;
+	}
+
+public:
+	static constexpr std::size_t chunk_size = chunkSize;
+
+	ChunkedTape() = default;
+
+	ChunkedTape(std::span<const T> cells) {
+		assign(cells);
+	}
+
+	void assign(std::span<const T> cells) {
+		clear();
+		for (std::size_t i = 0; i < cells.size(); i += chunkSize) {
+			auto chunk = std::make_shared<Chunk>();
+			std::ranges::copy(cells.subspan(i, std::min(chunkSize, cells.size() - i)), chunk->begin());
+			chunks_.push_back(std::move(chunk));
+		}
+		size_ = cells.size();
+	}
+
+	void clear() {
+		chunks_.clear();
+		size_ = 0;
+	}
+
+	void resize(std::size_t size, const T& value) {
+		while (size_ < size)
+			push_back(value);
+		size_ = size;
+		chunks_.resize((size + chunkSize - 1) / chunkSize);
+	}
+
+	void push_back(const T& value) {
+		if (size_ % chunkSize == 0)
+			chunks_.push_back(std::make_shared<Chunk>());
+		unique_chunk(size_ / chunkSize)[size_ % chunkSize] = value;
+		++size_;
+	}
+
+	[[nodiscard]] std::size_t size() const noexcept {
+		return size_;
+	}
+
+	[[nodiscard]] std::size_t chunks() const noexcept {
+		return chunks_.size();
+	}
+
+	[[nodiscard]] const T& operator[](std::size_t i) const {
+		return (*chunks_[i / chunkSize])[i % chunkSize];
+	}
+
+	// Only copies the chunk containing i, and only if it is shared
+	void set(std::size_t i, const T& value) {
+		unique_chunk(i / chunkSize)[i % chunkSize] = value;
+	}
+
+	// Whole chunk access, for callers partitioning work across threads by chunk
+	// Cells past size() in the last chunk are unspecified
+	[[nodiscard]] std::span<const T, chunkSize> chunk(std::size_t chunk) const {
+		return *chunks_[chunk];
+	}
+
+	[[nodiscard]] std::span<T, chunkSize> mutable_chunk(std::size_t chunk) {
+		return unique_chunk(chunk);
+	}
+
+	void copy_to(std::vector<T>& out) const {
+		copy_to(out, std::identity{});
+	}
+
+	template <typename U, typename F>
+	void copy_to(std::vector<U>& out, F transform) const {
+		out.resize(size_);
+		for (std::size_t i = 0; i < chunks_.size(); ++i) {
+			const std::size_t n = std::min(chunkSize, size_ - i * chunkSize);
+			std::ranges::transform(chunks_[i]->begin(), chunks_[i]->begin() + n, out.begin() + i * chunkSize, transform);
+		}
+	}
+
+	[[nodiscard]] bool operator==(const ChunkedTape& other) const {
+		return (*this <=> other) == 0;
+	}
+
+	// Lexicographic, chunks shared between both tapes are skipped without comparing their contents
+	[[nodiscard]] std::compare_three_way_result_t<T> operator<=>(const ChunkedTape& other) const {
+		const std::size_t common = std::min(size_, other.size_);
+		for (std::size_t i = 0; i * chunkSize < common; ++i) {
+			if (chunks_[i] == other.chunks_[i] && (i + 1) * chunkSize <= common)
+				continue;
+
+			const std::size_t n = std::min(chunkSize, common - i * chunkSize);
+			auto cmp = std::lexicographical_compare_three_way(
+				chunks_[i]->begin(), chunks_[i]->begin() + n,
+				other.chunks_[i]->begin(), other.chunks_[i]->begin() + n
+			);
+			if (cmp != 0)
+				return cmp;
+		}
+		return size_ <=> other.size_;
+	}
+};
+
+#endif // CHUNKED_TAPE_HPP
@@ -5,6 +5,7 @@
 
 #include <meta>
 #include <utility>
+#include <array>
 
 enum class Action {
 	Left,
@@ -13,6 +14,15 @@ enum class Action {
 	Halt
 };
 
+// How the next state of a transition is entered
+enum class Link {
+	Jump,
+	// Pushes the return state onto the call stack, then jumps
+	Call,
+	// Pops the call stack and jumps to the popped state
+	Return
+};
+
 struct StateRef {
 	structural::StringView name;
 	std::meta::info stateEnum;
@@ -23,6 +33,10 @@ struct Config {
 	structural::StringView startStateName;
 	Symbol emptySymbol;
 	Symbol anySymbol;
+	// Number of tapes; machines with more than one tape use MRL (Multi Response List) transitions
+	std::size_t tapes = 1;
+	// Bound on nested RCall depth
+	std::size_t maxCallDepth = 64;
 };
 namespace impl {
 	template <typename Scope>
@@ -78,10 +92,19 @@ struct CallLinker {};
 template <typename Machine>
 struct ConcreteCallLinker {};
 
+template <typename Machine, CallArg ret>
+struct ReturningCallLinker {};
+struct ReturnLinker {};
+
 template <template <auto...> typename Machine, CallArg... args>
 inline CallLinker<Machine, args...> Call;
 template <typename Machine>
 inline ConcreteCallLinker<Machine> CCall;
+// Calls a concrete machine which continues at ret once it reaches Ret (Returning Call)
+// Unlike Call the called machine is only instantiated once, however many places it returns to
+template <typename Machine, CallArg ret>
+inline ReturningCallLinker<Machine, ret> RCall;
+inline constexpr ReturnLinker Ret;
 
 namespace impl {
 	template <std::meta::info stateEnum>
@@ -98,6 +121,19 @@ namespace impl {
 		std::unreachable();
 	}
 
+	template <std::meta::info stateEnum>
+	consteval std::size_t get_tape_count() {
+		for (std::meta::info a : annotations_of(stateEnum)) {
+			std::meta::info type = type_of(a);
+			if (has_template_arguments(type) && template_of(type) == ^^Config)
+				return extract<typename [:substitute(
+					^^Config,
+					{get_symbol<typename [:stateEnum:]>()}
+				):]>(a).tapes;
+		}
+		std::unreachable();
+	}
+
 	template <typename T>
 	constexpr auto& prepend_helper(T x, std::vector<T>& vec) {
 		vec.insert(vec.begin(), x);
@@ -112,29 +148,32 @@ namespace impl {
 	template <typename Machine>
 	consteval StateRef resolve_concrete_call();
 
+	template <typename CurrentStateEnum, template <auto...> typename Machine, CallArg... args>
+	consteval StateRef resolve_parameterized_call();
+
+	// State names refer to the calling scope
+	template <typename CurrentStateEnum, CallArg arg>
+	consteval StateRef resolve_call_arg() {
+		constexpr auto type = decay(type_of(arg.refl));
+		if constexpr (type == ^^StateRef)
+			return [:arg.refl:];
+		else if constexpr (type == ^^structural::StringView)
+			return StateRef{[:arg.refl:], ^^CurrentStateEnum};
+		else if constexpr (has_template_arguments(type) && template_of(type) == ^^ConcreteCallLinker)
+			return resolve_concrete_call<typename [:template_arguments_of(type)[0]:]>();
+		else if constexpr (has_template_arguments(type) && template_of(type) == ^^CallLinker)
+			return [:substitute(^^resolve_parameterized_call, prepend_helper(^^CurrentStateEnum, template_arguments_of(type))):]();
+		else
+			throw "Unexpected type in Call parameter";
+	}
+
 	template <typename CurrentStateEnum, template <auto...> typename Machine, CallArg... args>
 	consteval StateRef resolve_parameterized_call() {
 		constexpr auto refs = [] {
 			std::vector<std::meta::info> refs{};
 			
 			auto handle_arg = [&refs]<CallArg arg>() {
-				constexpr auto type = decay(type_of(arg.refl));
-				if constexpr (type == ^^StateRef)
-					refs.push_back(arg.refl);
-				else if constexpr (type == ^^structural::StringView)
-					refs.push_back(std::meta::reflect_constant(StateRef{[:arg.refl:], ^^CurrentStateEnum}));
-				else if constexpr (has_template_arguments(type) && template_of(type) == ^^ConcreteCallLinker) {
-					refs.push_back(std::meta::reflect_constant(
-						resolve_concrete_call<typename [:template_arguments_of(type)[0]:]>()
-					));
-				}
-				else if constexpr (has_template_arguments(type) && template_of(type) == ^^CallLinker) {
-					refs.push_back(std::meta::reflect_constant(
-						[:substitute(^^resolve_parameterized_call, prepend_helper(^^CurrentStateEnum, template_arguments_of(type))):]()
-					)); 
-				}
-				else
-					throw "Unexpected type in Call parameter";
+				refs.push_back(std::meta::reflect_constant(resolve_call_arg<CurrentStateEnum, arg>()));
 			};
 			(handle_arg.template operator()<args>(), ...);
 
@@ -160,6 +199,9 @@ struct Response {
 	Symbol write;
 	Action action;
 	StateRef nextState;
+	Link link = Link::Jump;
+	// Only meaningful for Link::Call
+	StateRef returnState{};
 
 	constexpr Response(Symbol read, Symbol write, Action action, structural::StringView nextStateName)
 		: read(read), write(write), action(action), nextState(nextStateName, impl::get_state_enum<Scope>()) {}
@@ -174,6 +216,15 @@ struct Response {
 	template <typename Machine>
 	constexpr Response(Symbol read, Symbol write, Action action, ConcreteCallLinker<Machine> call)
 		: read(read), write(write), action(action), nextState(impl::resolve_concrete_call<Machine>()) {}
+
+	template <typename Machine, CallArg ret>
+	constexpr Response(Symbol read, Symbol write, Action action, ReturningCallLinker<Machine, ret> call)
+		: read(read), write(write), action(action), nextState(impl::resolve_concrete_call<Machine>()),
+		  link(Link::Call), returnState(impl::resolve_call_arg<typename [:impl::get_state_enum<Scope>():], ret>()) {}
+
+	// The next state is only known at runtime, nextState refers back to this scope to keep it well formed
+	constexpr Response(Symbol read, Symbol write, Action action, ReturnLinker ret)
+		: read(read), write(write), action(action), nextState("", impl::get_state_enum<Scope>()), link(Link::Return) {}
 };
 
 template <typename Scope, Response<Scope>...>
@@ -182,4 +233,37 @@ struct ResponseList {};
 template <typename Scope, Response<Scope>... Rs>
 inline ResponseList<Scope, Rs...> RL;
 
+// Transition for machines with Config::tapes > 1, each tape is read, written and moved independently
+// Halting on any tape halts the machine (after all writes are applied)
+template <typename Scope>
+struct MultiResponse {
+	using Symbol = [:impl::get_symbol<Scope>():];
+	static constexpr std::size_t tapes = impl::get_tape_count<impl::get_state_enum<Scope>()>();
+
+	std::array<Symbol, tapes> read;
+	std::array<Symbol, tapes> write;
+	std::array<Action, tapes> action;
+	StateRef nextState;
+
+	constexpr MultiResponse(std::array<Symbol, tapes> read, std::array<Symbol, tapes> write, std::array<Action, tapes> action, structural::StringView nextStateName)
+		: read(read), write(write), action(action), nextState(nextStateName, impl::get_state_enum<Scope>()) {}
+
+	constexpr MultiResponse(std::array<Symbol, tapes> read, std::array<Symbol, tapes> write, std::array<Action, tapes> action, StateRef nextState)
+		: read(read), write(write), action(action), nextState(nextState) {}
+
+	template <template <auto...> typename Machine, CallArg... args>
+	constexpr MultiResponse(std::array<Symbol, tapes> read, std::array<Symbol, tapes> write, std::array<Action, tapes> action, CallLinker<Machine, args...> call)
+		: read(read), write(write), action(action), nextState(impl::resolve_parameterized_call<typename [:impl::get_state_enum<Scope>():], Machine, args...>()) {}
+
+	template <typename Machine>
+	constexpr MultiResponse(std::array<Symbol, tapes> read, std::array<Symbol, tapes> write, std::array<Action, tapes> action, ConcreteCallLinker<Machine> call)
+		: read(read), write(write), action(action), nextState(impl::resolve_concrete_call<Machine>()) {}
+};
+
+template <typename Scope, MultiResponse<Scope>...>
+struct MultiResponseList {};
+
+template <typename Scope, MultiResponse<Scope>... Rs>
+inline MultiResponseList<Scope, Rs...> MRL;
+
 #endif // DECL_COMPONENTS_HPP
\ No newline at end of file
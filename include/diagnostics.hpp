@@ -0,0 +1,244 @@
+#ifndef DIAGNOSTICS_HPP
+#define DIAGNOSTICS_HPP
+
+#include "decl_components.hpp"
+#include "machine_graph.hpp"
+#include "symbol_table.hpp"
+
+#include <vector>
+#include <string>
+#include <meta>
+#include <span>
+#include <algorithm>
+#include <cstdint>
+
+// Problems in a (single tape) machine which would otherwise only surface at runtime
+struct MachineDiagnostics {
+	struct MissingResponse {
+		std::meta::info state;
+		// Null if the state has no ResponseList at all
+		std::meta::info symbol;
+	};
+
+	struct ShadowedResponse {
+		std::meta::info state;
+		// Position in the state's ResponseList
+		std::size_t index;
+	};
+
+	// Reading symbol in state loops through length transitions forever without moving the head
+	struct StationaryLoop {
+		std::meta::info state;
+		std::meta::info symbol;
+		std::size_t length;
+	};
+
+	// Enumerators of reachable machines which can't be reached from the start state
+	std::span<const std::meta::info> unreachable;
+	// Reachable (state, symbol) pairs in the state's own alphabet with no matching Response
+	std::span<const MissingResponse> missing;
+	// Responses which can never match, as an earlier Response reads any symbol or the same symbol
+	std::span<const ShadowedResponse> shadowed;
+	std::span<const StationaryLoop> loops;
+};
+
+// Which diagnostics verify_machine treats as errors
+struct DiagnosticChecks {
+	bool unreachable = true;
+	bool missing = true;
+	bool shadowed = true;
+	bool loops = true;
+};
+
+namespace impl {
+	consteval std::string symbol_name(std::meta::info symbol) {
+		std::meta::info type = type_of(symbol);
+		for (std::meta::info e : enumerators_of(type)) {
+			if (constant_of(e) == symbol)
+				return std::string(display_string_of(type)) + "::" + std::string(identifier_of(e));
+		}
+		throw "Symbol is not an enumerator of its type";
+	}
+
+	consteval std::string number_string(std::size_t n) {
+		std::string out;
+		do {
+			out.insert(out.begin(), static_cast<char>('0' + n % 10));
+			n /= 10;
+		} while (n != 0);
+		return out;
+	}
+
+	template <typename Descriptor>
+	consteval std::vector<bool> get_reachable_state_mask() {
+		constexpr MachineGraph graph = machine_graph<Descriptor>;
+
+		std::vector<bool> reachable(graph.states.size(), false);
+		std::vector<std::size_t> frontier{graph.index_of(get_start_state<Descriptor>())};
+		reachable[frontier.front()] = true;
+		while (!frontier.empty()) {
+			const ErasedState& state = graph.states[frontier.back()];
+			frontier.pop_back();
+			for (const ErasedResponse& response : graph.responses_of(state)) {
+				// A halting Response still names a state, but the machine never enters it
+				if (response.action == Action::Halt)
+					continue;
+				// Ret targets are the returnTo states of calls, which are visited through the call itself
+				for (std::meta::info next : {response.next, response.returnTo}) {
+					if (next == std::meta::info{})
+						continue;
+					const std::size_t id = graph.index_of(next);
+					if (!reachable[id]) {
+						reachable[id] = true;
+						frontier.push_back(id);
+					}
+				}
+			}
+		}
+		return reachable;
+	}
+
+	template <typename Descriptor>
+	consteval std::vector<MachineDiagnostics::StationaryLoop> get_stationary_loops(const std::vector<bool>& reachable) {
+		constexpr MachineGraph graph = machine_graph<Descriptor>;
+		constexpr SymbolNumbering numbering = SymbolTable<Descriptor>::numbering;
+		const std::size_t symbols = numbering.symbols.size();
+
+		// Nodes are (state ID, symbol ID) pairs, linked when the first matching Response jumps without moving
+		constexpr std::size_t none = static_cast<std::size_t>(-1);
+		std::vector<std::size_t> next(graph.states.size() * symbols, none);
+		for (std::size_t id = 0; id < graph.states.size(); ++id) {
+			if (!reachable[id])
+				continue;
+			for (std::size_t symbol = 0; symbol < symbols; ++symbol) {
+				const ErasedResponse* response = numbering.first_match(graph, graph.states[id], symbol);
+				if (response == nullptr || response->action != Action::None || response->link != Link::Jump)
+					continue;
+				const std::size_t written = response->anyWrite ? symbol : numbering.id_of(response->write);
+				next[id * symbols + symbol] = graph.index_of(response->next) * symbols + written;
+			}
+		}
+
+		// Walks start from the symbols of each state's own alphabet (as for missing Responses), other nodes are only reported if a walk writes its way into them
+		std::vector<std::size_t> starts;
+		for (std::size_t id = 0; id < graph.states.size(); ++id) {
+			if (!reachable[id])
+				continue;
+			const ErasedState& state = graph.states[id];
+			for (std::meta::info e : enumerators_of(type_of(state.anySymbol))) {
+				std::meta::info symbol = constant_of(e);
+				if (symbol != state.anySymbol)
+					starts.push_back(id * symbols + numbering.id_of(symbol));
+			}
+		}
+
+		// Each node has at most one successor, so every cycle reachable from a start is found by walking from it until a visited node
+		enum class Mark : std::uint8_t { Unvisited, OnPath, Done };
+		std::vector<Mark> marks(next.size(), Mark::Unvisited);
+		std::vector<MachineDiagnostics::StationaryLoop> loops;
+		for (std::size_t start : starts) {
+			std::vector<std::size_t> path;
+			std::size_t node = start;
+			while (node != none && marks[node] == Mark::Unvisited) {
+				marks[node] = Mark::OnPath;
+				path.push_back(node);
+				node = next[node];
+			}
+			if (node != none && marks[node] == Mark::OnPath) {
+				const auto length = static_cast<std::size_t>(path.end() - std::ranges::find(path, node));
+				loops.push_back({graph.states[node / symbols].enumerator, numbering.symbols[node % symbols], length});
+			}
+			for (std::size_t visited : path)
+				marks[visited] = Mark::Done;
+		}
+		return loops;
+	}
+
+	template <typename Descriptor>
+	consteval MachineDiagnostics diagnose() {
+		constexpr MachineGraph graph = machine_graph<Descriptor>;
+		const std::vector<bool> reachable = get_reachable_state_mask<Descriptor>();
+
+		std::vector<std::meta::info> unreachable;
+		std::vector<MachineDiagnostics::MissingResponse> missing;
+		std::vector<MachineDiagnostics::ShadowedResponse> shadowed;
+		for (std::size_t id = 0; id < graph.states.size(); ++id) {
+			const ErasedState& state = graph.states[id];
+			if (!reachable[id]) {
+				unreachable.push_back(state.enumerator);
+				continue;
+			}
+			if (!state.hasResponseList) {
+				missing.push_back({state.enumerator, std::meta::info{}});
+				continue;
+			}
+
+			auto responses = graph.responses_of(state);
+			for (std::meta::info e : enumerators_of(type_of(state.anySymbol))) {
+				std::meta::info symbol = constant_of(e);
+				if (symbol == state.anySymbol)
+					continue;
+				if (std::ranges::none_of(responses, [&](const ErasedResponse& response) { return response.anyRead || response.read == symbol; }))
+					missing.push_back({state.enumerator, symbol});
+			}
+
+			for (std::size_t i = 0; i < responses.size(); ++i) {
+				auto earlier = responses.first(i);
+				if (std::ranges::any_of(earlier, [&](const ErasedResponse& response) { return response.anyRead || (!responses[i].anyRead && response.read == responses[i].read); }))
+					shadowed.push_back({state.enumerator, i});
+			}
+		}
+
+		return MachineDiagnostics{
+			std::define_static_array(unreachable),
+			std::define_static_array(missing),
+			std::define_static_array(shadowed),
+			std::define_static_array(get_stationary_loops<Descriptor>(reachable))
+		};
+	}
+
+	consteval std::string format_diagnostics(const MachineDiagnostics& diagnostics, DiagnosticChecks checks) {
+		std::string out;
+		if (checks.unreachable) {
+			for (std::meta::info state : diagnostics.unreachable)
+				out += std::string(qualified_state_name(state)) + " is unreachable\n";
+		}
+		if (checks.missing) {
+			for (const auto& [state, symbol] : diagnostics.missing) {
+				if (symbol == std::meta::info{})
+					out += std::string(qualified_state_name(state)) + " is reachable but has no ResponseList\n";
+				else
+					out += std::string(qualified_state_name(state)) + " has no Response reading " + symbol_name(symbol) + "\n";
+			}
+		}
+		if (checks.shadowed) {
+			for (const auto& [state, index] : diagnostics.shadowed)
+				out += std::string(qualified_state_name(state)) + " Response " + number_string(index) + " is shadowed by an earlier Response\n";
+		}
+		if (checks.loops) {
+			for (const auto& [state, symbol, length] : diagnostics.loops)
+				out += std::string(qualified_state_name(state)) + " reading " + symbol_name(symbol) + " loops through " + number_string(length) + " transitions without moving\n";
+		}
+		return out;
+	}
+};
+
+template <typename Descriptor>
+inline constexpr MachineDiagnostics machine_diagnostics = impl::diagnose<Descriptor>();
+
+// One line per diagnostic, empty if the machine passes every enabled check
+template <typename Descriptor>
+consteval const char* diagnostics_report(DiagnosticChecks checks = {}) {
+	return std::define_static_string(impl::format_diagnostics(machine_diagnostics<Descriptor>, checks));
+}
+
+// Fails compilation with the report if any enabled check finds a problem, use as static_assert(verify_machine<Descriptor>())
+template <typename Descriptor>
+consteval bool verify_machine(DiagnosticChecks checks = {}) {
+	const std::string report = impl::format_diagnostics(machine_diagnostics<Descriptor>, checks);
+	if (!report.empty())
+		throw std::define_static_string(report);
+	return true;
+}
+
+#endif // DIAGNOSTICS_HPP
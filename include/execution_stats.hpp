@@ -0,0 +1,160 @@
+#ifndef EXECUTION_STATS_HPP
+#define EXECUTION_STATS_HPP
+
+#include <span>
+#include <array>
+#include <type_traits>
+#include <chrono>
+#include <ostream>
+#include <string_view>
+#include <print>
+#include <format>
+#include <string>
+#include <utility>
+#include <ranges>
+#include <cstddef>
+
+// Why execution stopped, faults leave the machine in the configuration the faulting transition was attempted from
+enum class ExecutionStatus {
+	Running,
+	Halted,
+	// No Response matches the symbol under the head
+	MissingTransition,
+	// Moved left of tape position 0
+	TapeUnderflow,
+	// RCall with Config::maxCallDepth calls already active
+	CallStackOverflow,
+	// Ret with no active call
+	CallStackUnderflow,
+	// Every branch of a nondeterministic execution was rejected
+	Rejected
+};
+
+// Multi-tape machines sum tape sizes over all tapes and report the head range over all heads
+struct ExecutionStats {
+	// Transitions performed, including the halting transition
+	std::size_t steps = 0;
+	// Leftmost and rightmost cells the head visited
+	std::size_t minHead = 0;
+	std::size_t maxHead = 0;
+	// Peak tape size in cells, and the memory allocated for it
+	std::size_t tapeHighWater = 0;
+	std::size_t tapeBytes = 0;
+	std::chrono::nanoseconds duration{};
+};
+
+// Tape of a finished execution along with its ExecutionStats and ExecutionStatus
+// Iterates as the tape, so results can be piped into views directly
+template <typename T, typename State>
+struct ExecutionResult {
+	std::span<T> tape;
+	ExecutionStats stats;
+	ExecutionStatus status;
+	// State and symbol under the head when execution stopped (the faulting pair unless halted)
+	State state;
+	std::remove_const_t<T> symbol;
+
+	[[nodiscard]] constexpr bool halted() const noexcept {
+		return status == ExecutionStatus::Halted;
+	}
+
+	[[nodiscard]] constexpr auto begin() const noexcept {
+		return tape.begin();
+	}
+
+	[[nodiscard]] constexpr auto end() const noexcept {
+		return tape.end();
+	}
+
+	[[nodiscard]] constexpr std::size_t size() const noexcept {
+		return tape.size();
+	}
+
+	[[nodiscard]] constexpr T& operator[](std::size_t i) const {
+		return tape[i];
+	}
+
+	constexpr operator std::span<T>() const noexcept {
+		return tape;
+	}
+};
+
+template <typename T, typename State, std::size_t tapeCount>
+struct MultiTapeExecutionResult {
+	std::array<std::span<T>, tapeCount> tapes;
+	ExecutionStats stats;
+	ExecutionStatus status;
+	State state;
+
+	[[nodiscard]] constexpr bool halted() const noexcept {
+		return status == ExecutionStatus::Halted;
+	}
+
+	[[nodiscard]] constexpr std::span<T> operator[](std::size_t i) const {
+		return tapes[i];
+	}
+};
+
+namespace impl {
+	inline void write_prometheus_label(std::ostream& out, std::string_view value) {
+		for (char c : value) {
+			switch (c) {
+			case '\\':
+				out << "\\\\";
+				break;
+			case '"':
+				out << "\\\"";
+				break;
+			case '\n':
+				out << "\\n";
+				break;
+			default:
+				out << c;
+			}
+		}
+	}
+
+	struct PrometheusGauge {
+		std::string_view name;
+		std::string_view help;
+		std::string (*value)(const ExecutionStats&);
+	};
+
+	inline constexpr std::array<PrometheusGauge, 6> prometheusGauges{{
+		{"steps", "Transitions performed", [](const ExecutionStats& stats) { return std::format("{}", stats.steps); }},
+		{"min_head", "Leftmost cell visited by the head", [](const ExecutionStats& stats) { return std::format("{}", stats.minHead); }},
+		{"max_head", "Rightmost cell visited by the head", [](const ExecutionStats& stats) { return std::format("{}", stats.maxHead); }},
+		{"tape_cells", "Peak tape size in cells", [](const ExecutionStats& stats) { return std::format("{}", stats.tapeHighWater); }},
+		{"tape_bytes", "Peak memory allocated for the tape in bytes", [](const ExecutionStats& stats) { return std::format("{}", stats.tapeBytes); }},
+		{"duration_seconds", "Wall clock execution time", [](const ExecutionStats& stats) { return std::format("{}", std::chrono::duration<double>(stats.duration).count()); }}
+	}};
+};
+
+// Prometheus text exposition format, one gauge per field with a sample per job
+// Jobs is a range of (job, ExecutionStats) pairs; HELP and TYPE may only appear once per metric, so every job written to one sink must go
+// through a single call
+template <std::ranges::forward_range Jobs>
+void write_prometheus(std::ostream& out, Jobs&& jobs) {
+	for (const impl::PrometheusGauge& gauge : impl::prometheusGauges) {
+		std::println(out, "# HELP turing_machine_{} {}", gauge.name, gauge.help);
+		std::println(out, "# TYPE turing_machine_{} gauge", gauge.name);
+		for (const auto& [job, stats] : jobs) {
+			std::print(out, "turing_machine_{}{{job=\"", gauge.name);
+			impl::write_prometheus_label(out, job);
+			std::println(out, "\"}} {}", gauge.value(stats));
+		}
+	}
+}
+
+inline void write_prometheus(std::ostream& out, const ExecutionStats& stats, std::string_view job) {
+	write_prometheus(out, std::array{std::pair<std::string_view, const ExecutionStats&>{job, stats}});
+}
+
+inline void write_json(std::ostream& out, const ExecutionStats& stats) {
+	std::println(out,
+		R"({{"steps":{},"minHead":{},"maxHead":{},"tapeHighWater":{},"tapeBytes":{},"durationNs":{}}})",
+		stats.steps, stats.minHead, stats.maxHead, stats.tapeHighWater, stats.tapeBytes, stats.duration.count()
+	);
+}
+
+#endif // EXECUTION_STATS_HPP
@@ -0,0 +1,164 @@
+#ifndef FUSION_HPP
+#define FUSION_HPP
+
+#include "decl_components.hpp"
+#include "machine_graph.hpp"
+#include "symbol_table.hpp"
+
+#include <vector>
+#include <meta>
+#include <span>
+#include <utility>
+#include <algorithm>
+#include <cstddef>
+
+namespace impl {
+	// Upper bound on the number of transitions fused into a single superinstruction
+	inline constexpr std::size_t maxFusedLength = 8;
+
+	struct FusedStep {
+		// State the step is taken from
+		std::meta::info state;
+		// Null when the step writes back the read symbol
+		std::meta::info write;
+		Action action;
+		Link link;
+		// State after the step (state itself for a halting step), null if the step returns
+		std::meta::info next;
+	};
+
+	// A chain of transitions whose outcome is known at compile time, executed as one superinstruction
+	struct FusedChain {
+		std::span<const FusedStep> steps;
+		// State after the last step (the halting state if halts), null if the last step returns
+		std::meta::info finalState;
+		bool halts;
+		// How the last step enters finalState, only a call or return needs the call stack
+		Link link;
+		// Null unless Link::Call
+		std::meta::info returnTo;
+		// Head offsets relative to the start of the chain, after the last step and at either extreme
+		std::ptrdiff_t offset;
+		std::ptrdiff_t lowest;
+		std::ptrdiff_t highest;
+	};
+
+	// Follows transitions from state `start` (a state ID) reading `symbol` (a symbol ID) for as long as the matching Response
+	// can be decided at compile time, so the symbol under the head is only dispatched on once
+	// The chain knows the cell it started on and every cell it has written since, so a Response reading a specific symbol is decidable
+	// whenever the head is on one of them; on any other cell only a leading any symbol read is
+	// A call or return ends the chain, since the state after it depends on the call stack
+	template <typename Descriptor>
+	consteval FusedChain fuse_chain(std::size_t start, std::size_t symbol) {
+		constexpr MachineGraph graph = machine_graph<Descriptor>;
+		constexpr SymbolNumbering numbering = SymbolTable<Descriptor>::numbering;
+
+		std::vector<FusedStep> steps;
+		// (head offset, symbol ID) of every cell known at compile time
+		std::vector<std::pair<std::ptrdiff_t, std::size_t>> window{{0, symbol}};
+		std::meta::info state = graph.states[start].enumerator;
+		bool halts = false;
+		Link link = Link::Jump;
+		std::meta::info returnTo{};
+		std::ptrdiff_t offset = 0, lowest = 0, highest = 0;
+
+		while (steps.size() < maxFusedLength) {
+			const ErasedState& erased = graph.states[graph.index_of(state)];
+			auto cell = std::ranges::find(window, offset, &std::pair<std::ptrdiff_t, std::size_t>::first);
+
+			const ErasedResponse* match = nullptr;
+			if (cell != window.end())
+				match = numbering.first_match(graph, erased, cell->second);
+			else if (erased.responseCount > 0 && graph.responses[erased.firstResponse].anyRead)
+				match = &graph.responses[erased.firstResponse];
+			if (match == nullptr)
+				break;
+
+			steps.push_back(FusedStep{state, match->anyWrite ? std::meta::info{} : match->write, match->action, match->link, match->action == Action::Halt ? state : match->next});
+			if (match->action == Action::Halt) {
+				halts = true;
+				break;
+			}
+
+			if (!match->anyWrite) {
+				if (cell != window.end())
+					cell->second = numbering.id_of(match->write);
+				else
+					window.emplace_back(offset, numbering.id_of(match->write));
+			}
+
+			if (match->action == Action::Left)
+				lowest = std::min(lowest, --offset);
+			else if (match->action == Action::Right)
+				highest = std::max(highest, ++offset);
+
+			link = match->link;
+			state = match->next;
+			if (link == Link::Call)
+				returnTo = match->returnTo;
+			if (link != Link::Jump)
+				break;
+		}
+
+		return FusedChain{std::define_static_array(steps), state, halts, link, returnTo, offset, lowest, highest};
+	}
+
+	template <typename Descriptor, std::size_t start, std::size_t symbol>
+	inline constexpr FusedChain fused_chain = fuse_chain<Descriptor>(start, symbol);
+
+	// Symbol IDs which can be under the head in state `id` without another machine having written them:
+	// its own alphabet, plus whatever a Response entering the state writes
+	template <typename Descriptor>
+	consteval std::vector<std::size_t> get_visible_symbols(std::size_t id) {
+		constexpr MachineGraph graph = machine_graph<Descriptor>;
+		constexpr SymbolNumbering numbering = SymbolTable<Descriptor>::numbering;
+		const ErasedState& state = graph.states[id];
+
+		std::vector<std::size_t> out;
+		for (std::meta::info e : enumerators_of(type_of(state.anySymbol))) {
+			std::meta::info symbol = constant_of(e);
+			if (symbol != state.anySymbol)
+				out.push_back(numbering.id_of(symbol));
+		}
+
+		// A return enters whichever state the call returns to, so it may enter any return target
+		const bool returnTarget = std::ranges::any_of(graph.responses, [&](const ErasedResponse& response) { return response.returnTo == state.enumerator; });
+		for (const ErasedResponse& response : graph.responses) {
+			const bool enters = response.link == Link::Return ? returnTarget : response.next == state.enumerator;
+			if (enters && !response.anyWrite)
+				out.push_back(numbering.id_of(response.write));
+		}
+
+		std::ranges::sort(out);
+		out.erase(std::ranges::unique(out).begin(), out.end());
+		return out;
+	}
+
+	struct FusedStart {
+		std::size_t state;
+		std::size_t symbol;
+	};
+
+	// Every (state ID, symbol ID) whose chain is worth running as a superinstruction, i.e. is longer than one transition
+	// Only visible symbols are fused, a state reading anything else steps one transition at a time
+	template <typename Descriptor>
+	consteval std::vector<FusedStart> get_fused_starts() {
+		constexpr MachineGraph graph = machine_graph<Descriptor>;
+
+		std::vector<FusedStart> out;
+		for (std::size_t id = 0; id < graph.states.size(); ++id) {
+			if (!graph.states[id].hasResponseList)
+				continue;
+			for (std::size_t symbol : get_visible_symbols<Descriptor>(id)) {
+				if (fuse_chain<Descriptor>(id, symbol).steps.size() > 1)
+					out.push_back({id, symbol});
+			}
+		}
+		return out;
+	}
+
+	template <typename Descriptor>
+	inline constexpr std::span<const FusedStart> fused_starts = std::define_static_array(get_fused_starts<Descriptor>());
+};
+
+#endif // FUSION_HPP
@@ -0,0 +1,217 @@
+#ifndef MACHINE_GRAPH_HPP
+#define MACHINE_GRAPH_HPP
+
+#include "utility.hpp"
+#include "decl_components.hpp"
+
+#include <vector>
+#include <ranges>
+#include <meta>
+#include <span>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <algorithm>
+
+namespace impl {
+	template <typename T>
+	struct LinearSet {
+		std::vector<T> data;
+		
+		constexpr void insert(T x) {
+			if (!std::ranges::contains(data, x))
+				data.push_back(std::move(x));
+		}
+	};
+
+	struct ReachableStatesAndSymbols {
+		LinearSet<std::meta::info> states;
+		LinearSet<std::meta::info> symbols;
+	};
+
+
+	template <std::meta::info e>
+	consteval auto get_enumerator_linked_scopes() -> LinearSet<std::meta::info> {
+		LinearSet<std::meta::info> linkedScopes;
+		template for (constexpr auto a : std::define_static_array(annotations_of(e))) {
+			constexpr auto type = type_of(a);
+			if constexpr (has_template_arguments(type) && (template_of(type) == ^^ResponseList || template_of(type) == ^^MultiResponseList)) {
+				// Found response list
+				template for (constexpr auto responseInfo : std::define_static_array(template_arguments_of(type) | std::views::drop(1))) {
+					constexpr auto response = [:responseInfo:];
+					linkedScopes.insert(response.nextState.stateEnum);
+					if constexpr (template_of(type) == ^^ResponseList && response.link == Link::Call)
+						linkedScopes.insert(response.returnState.stateEnum);
+				}
+			}
+		}
+		return linkedScopes;
+	}
+
+	template <typename Descriptor>
+	consteval void get_reachable_states_and_symbols_helper(ReachableStatesAndSymbols& out) {
+		out.symbols.insert(impl::get_symbol<Descriptor>());
+		constexpr auto stateEnum = impl::get_state_enum<Descriptor>();
+		out.states.insert(stateEnum);
+		
+		template for (constexpr auto e : std::define_static_array(enumerators_of(stateEnum))) {
+			template for (constexpr auto scope : std::define_static_array(get_enumerator_linked_scopes<e>().data)) {
+				if (!std::ranges::contains(out.states.data, scope))
+					get_reachable_states_and_symbols_helper<typename [:scope:]>(out);
+			}
+		}
+	}
+
+	template <typename Descriptor>
+	consteval ReachableStatesAndSymbols get_reachable_states_and_symbols() {
+		ReachableStatesAndSymbols out;
+		get_reachable_states_and_symbols_helper<Descriptor>(out);
+		return out;
+	}
+
+	template <typename Descriptor>
+	struct ComputedVariants {
+		using State = [:substitute(^^std::variant, get_reachable_states_and_symbols<Descriptor>().states.data):];
+		using Symbol = [:substitute(^^std::variant, get_reachable_states_and_symbols<Descriptor>().symbols.data):];
+	};
+
+	// Machines with different tape counts can't link to each other, since their transitions read a different number of cells
+	template <typename Descriptor>
+	consteval bool has_uniform_tape_count() {
+		constexpr auto tapes = get_tape_count<get_state_enum<Descriptor>()>();
+		template for (constexpr auto stateEnum : std::define_static_array(get_reachable_states_and_symbols<Descriptor>().states.data)) {
+			if (get_tape_count<stateEnum>() != tapes)
+				return false;
+		}
+		return true;
+	}
+};
+
+namespace impl {
+	// Type erased Response, so compile time passes can walk the transition graph without splicing each table
+	// Symbols are reflected constants, states are reflected enumerators
+	struct ErasedResponse {
+		std::meta::info read;
+		std::meta::info write;
+		bool anyRead;
+		bool anyWrite;
+		Action action;
+		Link link;
+		// Null for Link::Return
+		std::meta::info next;
+		// Null unless Link::Call
+		std::meta::info returnTo;
+	};
+
+	struct ErasedState {
+		std::meta::info enumerator;
+		std::meta::info anySymbol;
+		std::meta::info emptySymbol;
+		bool hasResponseList;
+		std::size_t firstResponse;
+		std::size_t responseCount;
+	};
+
+	struct MachineGraph {
+		std::span<const ErasedState> states;
+		std::span<const ErasedResponse> responses;
+
+		[[nodiscard]] consteval const ErasedState* find(std::meta::info enumerator) const {
+			for (const ErasedState& state : states) {
+				if (state.enumerator == enumerator)
+					return &state;
+			}
+			return nullptr;
+		}
+
+		// States are numbered by their position in states
+		[[nodiscard]] consteval std::size_t index_of(std::meta::info enumerator) const {
+			for (std::size_t i = 0; i < states.size(); ++i) {
+				if (states[i].enumerator == enumerator)
+					return i;
+			}
+			throw "State is not reachable";
+		}
+
+		[[nodiscard]] consteval std::span<const ErasedResponse> responses_of(const ErasedState& state) const {
+			return responses.subspan(state.firstResponse, state.responseCount);
+		}
+	};
+
+	consteval std::meta::info find_enumerator(StateRef ref) {
+		for (std::meta::info e : enumerators_of(ref.stateEnum)) {
+			if (identifier_of(e) == std::string_view(ref.name))
+				return e;
+		}
+		throw "Reference to a state name which does not exist in the referenced scope";
+	}
+
+	// Scope::State, with the scope of a class member enum named by its class
+	consteval const char* qualified_state_name(std::meta::info enumerator) {
+		auto stateEnum = parent_of(enumerator);
+		auto scope = is_class_member(stateEnum) ? display_string_of(parent_of(stateEnum)) : display_string_of(stateEnum);
+		return std::define_static_string(std::string(scope) + "::" + std::string(identifier_of(enumerator)));
+	}
+
+	template <typename Descriptor>
+	consteval std::meta::info get_start_state() {
+		constexpr auto stateEnum = get_state_enum<Descriptor>();
+		return find_enumerator(StateRef{get_start_state_name<stateEnum>(), stateEnum});
+	}
+
+	template <auto response>
+	consteval ErasedResponse erase_response(auto anySymbol) {
+		return ErasedResponse{
+			.read = std::meta::reflect_constant(response.read),
+			.write = std::meta::reflect_constant(response.write),
+			.anyRead = response.read == anySymbol,
+			.anyWrite = response.write == anySymbol,
+			.action = response.action,
+			.link = response.link,
+			.next = response.link == Link::Return ? std::meta::info{} : find_enumerator(response.nextState),
+			.returnTo = response.link == Link::Call ? find_enumerator(response.returnState) : std::meta::info{}
+		};
+	}
+
+	// Every reachable state with its (single tape) Responses in declaration order
+	template <typename Descriptor>
+	consteval MachineGraph get_machine_graph() {
+		std::vector<ErasedState> states;
+		std::vector<ErasedResponse> responses;
+
+		template for (constexpr auto stateEnum : std::define_static_array(get_reachable_states_and_symbols<Descriptor>().states.data)) {
+			using Symbol = [:get_symbol<typename [:stateEnum:]>():];
+			constexpr auto config = annotation_of<Config<Symbol>>(dealias(stateEnum));
+
+			template for (constexpr auto e : std::define_static_array(enumerators_of(stateEnum))) {
+				ErasedState state{
+					.enumerator = e,
+					.anySymbol = std::meta::reflect_constant(config->anySymbol),
+					.emptySymbol = std::meta::reflect_constant(config->emptySymbol),
+					.hasResponseList = false,
+					.firstResponse = responses.size(),
+					.responseCount = 0
+				};
+				template for (constexpr auto a : std::define_static_array(annotations_of(e))) {
+					constexpr auto type = type_of(a);
+					if constexpr (has_template_arguments(type) && template_of(type) == ^^ResponseList) {
+						state.hasResponseList = true;
+						template for (constexpr auto responseInfo : std::define_static_array(template_arguments_of(type) | std::views::drop(1))) {
+							constexpr auto response = [:responseInfo:];
+							responses.push_back(erase_response<response>(config->anySymbol));
+							++state.responseCount;
+						}
+					}
+				}
+				states.push_back(state);
+			}
+		}
+
+		return MachineGraph{std::define_static_array(states), std::define_static_array(responses)};
+	}
+
+	template <typename Descriptor>
+	inline constexpr MachineGraph machine_graph = get_machine_graph<Descriptor>();
+};
+
+#endif // MACHINE_GRAPH_HPP
@@ -0,0 +1,228 @@
+#ifndef MULTI_TAPE_TURING_MACHINE_HPP
+#define MULTI_TAPE_TURING_MACHINE_HPP
+
+#include "utility.hpp"
+#include "decl_components.hpp"
+#include "machine_graph.hpp"
+#include "symbol_table.hpp"
+#include "turing_machine.hpp"
+#include "execution_stats.hpp"
+
+#include <vector>
+#include <array>
+#include <ranges>
+#include <meta>
+#include <span>
+#include <utility>
+#include <print>
+#include <variant>
+#include <algorithm>
+#include <iterator>
+#include <cstdint>
+#include <type_traits>
+#include <chrono>
+
+namespace impl {
+	// MultiResponseList annotating a state enumerator, null if it has none
+	consteval std::meta::info get_multi_response_list(std::meta::info enumerator) {
+		for (std::meta::info a : annotations_of(enumerator)) {
+			std::meta::info type = type_of(a);
+			if (has_template_arguments(type) && template_of(type) == ^^MultiResponseList)
+				return type;
+		}
+		return std::meta::info{};
+	}
+};
+
+template <typename Descriptor>
+class MultiTapeTuringMachine {
+	static constexpr std::size_t tapeCount = impl::get_tape_count<impl::get_state_enum<Descriptor>()>();
+	static_assert(impl::has_uniform_tape_count<Descriptor>(), "All reachable machines must declare the same number of tapes");
+
+	using StateVariant = impl::ComputedVariants<Descriptor>::State;
+	using SymbolVariant = impl::ComputedVariants<Descriptor>::Symbol;
+	// Cells and states are numbered as in TuringMachine, so matching a transition is a comparison of small integers
+	using Symbols = impl::SymbolTable<Descriptor>;
+	using SymbolId = Symbols::Id;
+
+	static constexpr impl::MachineGraph graph = impl::machine_graph<Descriptor>;
+	static constexpr std::size_t stateCount = graph.states.size();
+	using StateId = std::conditional_t<(stateCount <= 65536), std::uint16_t, std::uint32_t>;
+	static constexpr StateId startState = graph.index_of(impl::get_start_state<Descriptor>());
+
+	// Stands for the any symbol in symbol_ids, outside the range of real symbol IDs
+	static constexpr std::size_t anyId = Symbols::count;
+
+	std::array<std::vector<SymbolId>, tapeCount> tapes_;
+	// Heads are stored as indices since growing one tape must not invalidate the others
+	std::array<std::size_t, tapeCount> heads_{};
+	StateId state_ = startState;
+	ExecutionStatus status_ = ExecutionStatus::Running;
+	std::size_t steps_ = 0;
+	// Leftmost and rightmost cells visited by any head
+	std::size_t minHead_ = 0;
+	std::size_t maxHead_ = 0;
+	// Decoded copies of tapes_ handed out by execute
+	std::array<std::vector<SymbolVariant>, tapeCount> outputs_;
+
+	[[nodiscard]] static constexpr StateVariant to_state_variant(StateId state) {
+		static constexpr auto table = [] {
+			std::array<StateVariant, stateCount> out;
+			std::size_t i = 0;
+			template for (constexpr impl::ErasedState erased : std::define_static_array(graph.states))
+				out[i++] = [:erased.enumerator:];
+			return out;
+		}();
+		return table[state];
+	}
+
+	// Global symbol ID of each tape's symbol, anyId for the any symbol
+	template <typename Symbol>
+	static consteval std::array<std::size_t, tapeCount> symbol_ids(std::array<Symbol, tapeCount> symbols, std::meta::info anySymbol) {
+		std::array<std::size_t, tapeCount> out;
+		for (std::size_t i = 0; i < tapeCount; ++i) {
+			std::meta::info symbol = std::meta::reflect_constant(symbols[i]);
+			out[i] = symbol == anySymbol ? anyId : Symbols::id_of(symbol);
+		}
+		return out;
+	}
+
+	constexpr bool stop(ExecutionStatus status) {
+		status_ = status;
+		return true;
+	}
+
+	template <std::meta::info responseInfo, std::meta::info anySymbol>
+	[[nodiscard]] constexpr bool matches() const {
+		static constexpr auto reads = symbol_ids(([:responseInfo:]).read, anySymbol);
+		for (std::size_t i = 0; i < tapeCount; ++i) {
+			if (reads[i] != anyId && tapes_[i][heads_[i]] != reads[i])
+				return false;
+		}
+		return true;
+	}
+
+	// Takes a matching transition, returns true for the step loop once stopped
+	template <std::meta::info responseInfo, std::meta::info anySymbol>
+	constexpr bool take() {
+		static constexpr auto response = [:responseInfo:];
+		static constexpr auto writes = symbol_ids(response.write, anySymbol);
+		for (std::size_t i = 0; i < tapeCount; ++i) {
+			if (response.action[i] == Action::Left && heads_[i] == 0)
+				return stop(ExecutionStatus::TapeUnderflow);
+		}
+
+		++steps_;
+		bool halt = false;
+		for (std::size_t i = 0; i < tapeCount; ++i) {
+			auto& tape = tapes_[i];
+			auto& head = heads_[i];
+
+			if (writes[i] != anyId)
+				tape[head] = static_cast<SymbolId>(writes[i]);
+
+			switch (response.action[i]) {
+			case Action::Left:
+				minHead_ = std::min(minHead_, --head);
+				break;
+			case Action::Right:
+				if (++head == tape.size())
+					tape.push_back(Symbols::blank);
+				maxHead_ = std::max(maxHead_, head);
+			case Action::None:
+				break;
+			case Action::Halt:
+				halt = true;
+				break;
+			default:
+				std::unreachable();
+			}
+		}
+		if (halt)
+			return stop(ExecutionStatus::Halted);
+
+		constexpr StateId next = graph.index_of(impl::find_enumerator(response.nextState));
+		state_ = next;
+		return false;
+	}
+
+	// Tries the state's MultiResponses in declaration order
+	template <std::size_t id>
+	struct StepState {
+		static constexpr bool run(MultiTapeTuringMachine& tm) {
+			constexpr impl::ErasedState state = graph.states[id];
+			constexpr std::meta::info list = impl::get_multi_response_list(state.enumerator);
+			if constexpr (list == std::meta::info{})
+				return tm.stop(ExecutionStatus::MissingTransition);
+			else {
+				template for (constexpr std::meta::info responseInfo : std::define_static_array(template_arguments_of(list) | std::views::drop(1))) {
+					if (tm.template matches<responseInfo, state.anySymbol>())
+						return tm.template take<responseInfo, state.anySymbol>();
+				}
+				return tm.stop(ExecutionStatus::MissingTransition);
+			}
+		}
+	};
+
+	// Performs a single transition, returns true once the machine has stopped
+	constexpr bool step() {
+		static constexpr auto handlers = []<std::size_t... ids>(std::index_sequence<ids...>) {
+			return std::array{&StepState<ids>::run...};
+		}(std::make_index_sequence<stateCount>{});
+		return handlers[state_](*this);
+	}
+
+	[[nodiscard]] constexpr MultiTapeExecutionResult<SymbolVariant, StateVariant, tapeCount> execute_impl(bool printStates = false) {
+		const auto begin = std::chrono::steady_clock::now();
+		bool stopped = status_ != ExecutionStatus::Running;
+		while (!stopped) {
+			stopped = step();
+			if (printStates && !stopped)
+				std::visit([](auto state) { std::println("{}::{}", get_scope_string(state), enum_to_string(state)); }, to_state_variant(state_));
+		}
+
+		// Tapes never shrink during a run, so the final sizes are the peak
+		ExecutionStats stats{.steps = steps_, .minHead = minHead_, .maxHead = maxHead_, .duration = std::chrono::steady_clock::now() - begin};
+		for (const auto& tape : tapes_) {
+			stats.tapeHighWater += tape.size();
+			stats.tapeBytes += tape.capacity() * sizeof(SymbolId);
+		}
+
+		MultiTapeExecutionResult<SymbolVariant, StateVariant, tapeCount> out{{}, stats, status_, to_state_variant(state_)};
+		for (std::size_t i = 0; i < tapeCount; ++i) {
+			outputs_[i].clear();
+			std::ranges::transform(tapes_[i], std::back_inserter(outputs_[i]), Symbols::decode);
+			out.tapes[i] = outputs_[i];
+		}
+		return out;
+	}
+
+public:
+	constexpr void reset() {
+		state_ = startState;
+		heads_.fill(0);
+		status_ = ExecutionStatus::Running;
+		steps_ = minHead_ = maxHead_ = 0;
+	}
+
+	constexpr MultiTapeTuringMachine() = default;
+
+	// Input is placed on the first tape, all other tapes start as a single empty cell
+	[[nodiscard]] constexpr MultiTapeExecutionResult<SymbolVariant, StateVariant, tapeCount> execute(std::vector<SymbolVariant> input, bool printStates = false) {
+		for (auto& tape : tapes_)
+			tape.assign(1, Symbols::blank);
+		if (!input.empty()) {
+			tapes_[0].clear();
+			std::ranges::transform(input, std::back_inserter(tapes_[0]), Symbols::encode);
+		}
+		reset();
+
+		return execute_impl(printStates);
+	}
+
+	[[nodiscard]] constexpr MultiTapeExecutionResult<SymbolVariant, StateVariant, tapeCount> execute(bool printStates = false) {
+		return execute({}, printStates);
+	}
+};
+
+#endif // MULTI_TAPE_TURING_MACHINE_HPP
@@ -0,0 +1,345 @@
+#ifndef PACKED_TABLE_HPP
+#define PACKED_TABLE_HPP
+
+#include "decl_components.hpp"
+#include "machine_graph.hpp"
+#include "symbol_table.hpp"
+#include "runtime_table.hpp"
+
+#include <vector>
+#include <map>
+#include <span>
+#include <optional>
+#include <stdexcept>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+enum class TableLayout {
+	// One entry per (state, symbol)
+	Dense,
+	// Per state fallback entry plus a short list of exceptions, searched linearly
+	Compressed,
+	// Per state fallback entry plus a perfect hashed table of exceptions
+	Hashed,
+	// The RuntimeTable's own transitions, for tables with more states, symbols or call sites than a PackedEntry can address
+	Unpacked
+};
+
+// 4 byte transition: next state (16 bits), write (10 bits), action (2 bits), link (2 bits), writes, defined
+// For Link::Call, next indexes PackedTable::calls instead since a call needs two states
+struct PackedEntry {
+	std::uint32_t bits = 0;
+
+	static constexpr std::size_t maxStates = std::size_t{1} << 16;
+	static constexpr std::size_t maxSymbols = std::size_t{1} << 10;
+
+	[[nodiscard]] static constexpr PackedEntry pack(std::uint32_t next, std::uint16_t write, Action action, Link link, bool writes) {
+		return PackedEntry{
+			next
+			| std::uint32_t{write} << 16
+			| static_cast<std::uint32_t>(action) << 26
+			| static_cast<std::uint32_t>(link) << 28
+			| std::uint32_t{writes} << 30
+			| std::uint32_t{1} << 31
+		};
+	}
+
+	[[nodiscard]] constexpr std::uint32_t next() const noexcept {
+		return bits & 0xFFFF;
+	}
+
+	[[nodiscard]] constexpr std::uint16_t write() const noexcept {
+		return static_cast<std::uint16_t>((bits >> 16) & 0x3FF);
+	}
+
+	[[nodiscard]] constexpr Action action() const noexcept {
+		return static_cast<Action>((bits >> 26) & 0x3);
+	}
+
+	[[nodiscard]] constexpr Link link() const noexcept {
+		return static_cast<Link>((bits >> 28) & 0x3);
+	}
+
+	[[nodiscard]] constexpr bool writes() const noexcept {
+		return (bits >> 30) & 0x1;
+	}
+
+	// False when no Response matches
+	[[nodiscard]] constexpr bool defined() const noexcept {
+		return bits >> 31;
+	}
+
+	constexpr bool operator==(const PackedEntry&) const = default;
+};
+static_assert(sizeof(PackedEntry) == 4);
+
+struct PackedCall {
+	std::uint32_t next;
+	std::uint32_t returnTo;
+};
+
+struct PackedRow {
+	// Entry for every symbol without an exception
+	PackedEntry fallback;
+	// First exception (Compressed) or slot (Hashed) of the row
+	std::uint32_t offset;
+	// Hashed only
+	std::uint32_t multiplier;
+	// Compressed only
+	std::uint16_t count;
+	// Hashed only, slot count - 1
+	std::uint16_t mask;
+};
+
+// RuntimeTable packed into one of the TableLayouts, see pack_table (empty if Unpacked)
+struct PackedTable {
+	TableLayout layout;
+	std::size_t symbols;
+	// Dense: [state][symbol], otherwise exception or slot entries
+	std::vector<PackedEntry> entries;
+	// Symbol of each exception or slot entry, emptyKey for unused slots
+	std::vector<std::uint16_t> keys;
+	std::vector<PackedRow> rows;
+	std::vector<PackedCall> calls;
+
+	static constexpr std::uint16_t emptyKey = 0xFFFF;
+
+	[[nodiscard]] static constexpr std::uint32_t hash(std::uint16_t symbol, std::uint32_t multiplier) noexcept {
+		return (std::uint32_t{symbol} * multiplier) >> 16;
+	}
+
+	// The layout is a template parameter so callers dispatch on it once, outside their step loop
+	template <TableLayout layout>
+	[[nodiscard]] constexpr PackedEntry at(std::uint32_t state, std::uint16_t symbol) const {
+		if constexpr (layout == TableLayout::Dense)
+			return entries[state * symbols + symbol];
+		else if constexpr (layout == TableLayout::Compressed) {
+			const PackedRow& row = rows[state];
+			for (std::uint32_t i = row.offset; i < row.offset + row.count; ++i) {
+				if (keys[i] == symbol)
+					return entries[i];
+			}
+			return row.fallback;
+		}
+		else {
+			const PackedRow& row = rows[state];
+			const std::uint32_t slot = row.offset + (hash(symbol, row.multiplier) & row.mask);
+			return keys[slot] == symbol ? entries[slot] : row.fallback;
+		}
+	}
+
+	[[nodiscard]] constexpr std::size_t bytes() const noexcept {
+		return entries.size() * sizeof(PackedEntry) + keys.size() * sizeof(std::uint16_t) + rows.size() * sizeof(PackedRow) + calls.size() * sizeof(PackedCall);
+	}
+};
+
+namespace impl {
+	// Dense tables up to this size are used regardless of sparsity, a single load beats any search
+	inline constexpr std::size_t denseTableBudget = 64 * 1024;
+	// Rows with more exceptions than this are not linearly searched
+	inline constexpr std::size_t maxLinearExceptions = 8;
+
+	struct LayoutStats {
+		std::size_t states;
+		std::size_t symbols;
+		std::size_t exceptions;
+		std::size_t maxRowExceptions;
+		std::size_t hashedSlots;
+		// Distinct (next, returnTo) pairs of calls, each takes a PackedCall
+		std::size_t callSites;
+	};
+
+	constexpr std::size_t hashed_row_slots(std::size_t exceptions) {
+		return std::bit_ceil(std::max<std::size_t>(exceptions, 1));
+	}
+
+	constexpr bool fits_packed(const LayoutStats& stats) {
+		return stats.states <= PackedEntry::maxStates && stats.symbols <= PackedEntry::maxSymbols && stats.callSites <= PackedEntry::maxStates;
+	}
+
+	// Smallest layout for the table, preferring dense while it stays cache resident
+	constexpr TableLayout choose_layout(const LayoutStats& stats) {
+		if (!fits_packed(stats))
+			return TableLayout::Unpacked;
+
+		const std::size_t dense = stats.states * stats.symbols * sizeof(PackedEntry);
+		if (dense <= denseTableBudget)
+			return TableLayout::Dense;
+
+		const std::size_t rows = stats.states * sizeof(PackedRow);
+		const std::size_t compressed = rows + stats.exceptions * (sizeof(PackedEntry) + sizeof(std::uint16_t));
+		const std::size_t hashed = rows + stats.hashedSlots * (sizeof(PackedEntry) + sizeof(std::uint16_t));
+		if (stats.maxRowExceptions <= maxLinearExceptions && compressed < dense)
+			return TableLayout::Compressed;
+		return hashed < dense ? TableLayout::Hashed : TableLayout::Dense;
+	}
+
+	// Transitions with equal keys pack to equal entries, so they can share a row's fallback
+	struct TransitionKey {
+		bool defined = false;
+		std::uint32_t next = 0;
+		std::uint32_t returnTo = 0;
+		std::uint16_t write = 0;
+		Action action{};
+		Link link{};
+		bool writes = false;
+
+		constexpr auto operator<=>(const TransitionKey&) const = default;
+	};
+
+	// Transitions which don't write store no write symbol, so any symbol reads get identical keys
+	constexpr TransitionKey transition_key(const RuntimeTransition& t) {
+		if (!t.defined)
+			return TransitionKey{};
+		return TransitionKey{true, t.next, t.link == Link::Call ? t.returnTo : 0, t.writes ? t.write : std::uint16_t{0}, t.action, t.link, t.writes};
+	}
+
+	// Symbol whose transition is the most common in the row, so the fewest symbols need exceptions
+	constexpr std::size_t row_fallback(std::span<const RuntimeTransition> row) {
+		std::vector<TransitionKey> sorted(row.size());
+		std::ranges::transform(row, sorted.begin(), transition_key);
+		std::ranges::sort(sorted);
+
+		TransitionKey best{};
+		std::size_t bestCount = 0;
+		for (auto it = sorted.begin(); it != sorted.end();) {
+			auto end = std::ranges::upper_bound(it, sorted.end(), *it);
+			if (static_cast<std::size_t>(end - it) > bestCount) {
+				best = *it;
+				bestCount = static_cast<std::size_t>(end - it);
+			}
+			it = end;
+		}
+		return static_cast<std::size_t>(std::ranges::find(row, best, transition_key) - row.begin());
+	}
+
+	constexpr std::size_t row_exceptions(std::span<const RuntimeTransition> row, std::size_t fallback) {
+		return static_cast<std::size_t>(std::ranges::count_if(row, [&](const RuntimeTransition& t) { return transition_key(t) != transition_key(row[fallback]); }));
+	}
+
+	// Counts exceptions against each row's most common transition, shared by table_layout and pack_table so both choose the same layout
+	constexpr LayoutStats get_layout_stats(std::span<const RuntimeTransition> transitions, std::size_t states, std::size_t symbols) {
+		LayoutStats stats{states, symbols, 0, 0, 0, 0};
+
+		std::vector<std::pair<std::uint32_t, std::uint32_t>> calls;
+		for (const RuntimeTransition& t : transitions) {
+			if (t.defined && t.link == Link::Call)
+				calls.emplace_back(t.next, t.returnTo);
+		}
+		std::ranges::sort(calls);
+		stats.callSites = static_cast<std::size_t>(std::ranges::unique(calls).begin() - calls.begin());
+
+		for (std::size_t state = 0; state < states; ++state) {
+			auto row = transitions.subspan(state * symbols, symbols);
+			const std::size_t exceptions = row_exceptions(row, row_fallback(row));
+			stats.exceptions += exceptions;
+			stats.maxRowExceptions = std::max(stats.maxRowExceptions, exceptions);
+			stats.hashedSlots += hashed_row_slots(exceptions);
+		}
+		return stats;
+	}
+};
+
+// Chosen at compile time for each reflected machine from its exported transitions, pack_table(export_table<Descriptor>()) chooses the same layout
+template <typename Descriptor>
+inline constexpr TableLayout table_layout = impl::choose_layout(impl::get_layout_stats(
+	impl::get_exported_transitions<Descriptor>(),
+	impl::machine_graph<Descriptor>.states.size(),
+	impl::SymbolTable<Descriptor>::count
+));
+
+// Packs table into layout, or the layout chosen by the same rules as table_layout if none is given
+// Tables which don't fit a PackedEntry are left Unpacked unless a packed layout is asked for explicitly, which throws
+inline PackedTable pack_table(const RuntimeTable& table, std::optional<TableLayout> layout = std::nullopt) {
+	const impl::LayoutStats stats = impl::get_layout_stats(table.transitions, table.states.size(), table.symbols.size());
+	PackedTable out{layout.value_or(impl::choose_layout(stats)), table.symbols.size(), {}, {}, {}, {}};
+	if (out.layout == TableLayout::Unpacked)
+		return out;
+	if (table.states.size() > PackedEntry::maxStates)
+		throw std::runtime_error("Too many states to pack machine table");
+	if (table.symbols.size() > PackedEntry::maxSymbols)
+		throw std::runtime_error("Too many symbols to pack machine table");
+	if (stats.callSites > PackedEntry::maxStates)
+		throw std::runtime_error("Too many call sites to pack machine table");
+
+	// Entries are equal exactly when their transition_keys are (call sites are shared), so rows split into the same exceptions as in get_layout_stats
+	std::map<std::pair<std::uint32_t, std::uint32_t>, std::uint32_t> callIds;
+	std::vector<PackedEntry> dense;
+	dense.reserve(table.transitions.size());
+	for (const RuntimeTransition& t : table.transitions) {
+		if (!t.defined) {
+			dense.push_back(PackedEntry{});
+			continue;
+		}
+		std::uint32_t next = t.next;
+		if (t.link == Link::Call) {
+			auto [it, inserted] = callIds.try_emplace({t.next, t.returnTo}, static_cast<std::uint32_t>(out.calls.size()));
+			if (inserted)
+				out.calls.push_back(PackedCall{t.next, t.returnTo});
+			next = it->second;
+		}
+		dense.push_back(PackedEntry::pack(next, t.writes ? t.write : 0, t.action, t.link, t.writes));
+	}
+
+	auto row = [&](std::size_t state) {
+		return std::span<const PackedEntry>(dense).subspan(state * out.symbols, out.symbols);
+	};
+	if (out.layout == TableLayout::Dense) {
+		out.entries = std::move(dense);
+		return out;
+	}
+
+	std::vector<PackedEntry> fallbacks;
+	for (std::size_t state = 0; state < table.states.size(); ++state)
+		fallbacks.push_back(row(state)[impl::row_fallback(std::span(table.transitions).subspan(state * out.symbols, out.symbols))]);
+
+	for (std::size_t state = 0; state < table.states.size(); ++state) {
+		std::vector<std::uint16_t> symbols;
+		for (std::size_t symbol = 0; symbol < out.symbols; ++symbol) {
+			if (row(state)[symbol] != fallbacks[state])
+				symbols.push_back(static_cast<std::uint16_t>(symbol));
+		}
+
+		PackedRow packed{fallbacks[state], static_cast<std::uint32_t>(out.entries.size()), 0, 0, 0};
+		if (out.layout == TableLayout::Compressed) {
+			packed.count = static_cast<std::uint16_t>(symbols.size());
+			for (std::uint16_t symbol : symbols) {
+				out.keys.push_back(symbol);
+				out.entries.push_back(row(state)[symbol]);
+			}
+		}
+		else {
+			// Search for a multiplier which maps every exception to its own slot, growing the table if none is found
+			std::size_t slots = 0;
+			for (std::uint32_t attempt = 0;; ++attempt) {
+				slots = impl::hashed_row_slots(symbols.size()) << (attempt / 64);
+				const std::uint32_t multiplier = 0x9E3779B1u + 2 * (attempt % 64) * 0x10001u;
+				std::vector<bool> used(slots, false);
+				const bool perfect = std::ranges::all_of(symbols, [&](std::uint16_t symbol) {
+					const std::size_t slot = PackedTable::hash(symbol, multiplier) & (slots - 1);
+					if (used[slot])
+						return false;
+					used[slot] = true;
+					return true;
+				});
+				if (perfect) {
+					packed.multiplier = multiplier;
+					break;
+				}
+			}
+			packed.mask = static_cast<std::uint16_t>(slots - 1);
+			out.keys.resize(out.keys.size() + slots, PackedTable::emptyKey);
+			out.entries.resize(out.entries.size() + slots);
+			for (std::uint16_t symbol : symbols) {
+				const std::size_t slot = packed.offset + (PackedTable::hash(symbol, packed.multiplier) & packed.mask);
+				out.keys[slot] = symbol;
+				out.entries[slot] = row(state)[symbol];
+			}
+		}
+		out.rows.push_back(packed);
+	}
+	return out;
+}
+
+#endif // PACKED_TABLE_HPP
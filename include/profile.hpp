@@ -0,0 +1,146 @@
+#ifndef PROFILE_HPP
+#define PROFILE_HPP
+
+#include "decl_components.hpp"
+#include "machine_graph.hpp"
+#include "symbol_table.hpp"
+
+#include <vector>
+#include <array>
+#include <meta>
+#include <span>
+#include <ostream>
+#include <print>
+#include <algorithm>
+#include <numeric>
+#include <cstdint>
+
+// Hit count of every Response of Descriptor's reachable graph (indexed like impl::MachineGraph::responses), empty if unprofiled
+// Specialised by the include file produced by write_profile, which must be included before the machine is instantiated
+template <typename Descriptor>
+inline constexpr std::span<const std::uint64_t> response_profile{};
+
+// Signature of the machine the profile was generated for, see impl::get_profile_signature
+template <typename Descriptor>
+inline constexpr std::uint64_t response_profile_signature = 0;
+
+namespace impl {
+	// FNV-1a over the (state ID, read symbol ID) pair of every Response, with ~0 for any symbol reads
+	// Reordering, adding or changing reads changes the signature, so a stale profile can't reorder the wrong Responses
+	template <typename Descriptor>
+	consteval std::uint64_t get_profile_signature() {
+		constexpr MachineGraph graph = machine_graph<Descriptor>;
+		constexpr SymbolNumbering numbering = SymbolTable<Descriptor>::numbering;
+
+		std::uint64_t hash = 0xcbf29ce484222325;
+		auto mix = [&](std::uint64_t x) { hash = (hash ^ x) * 0x100000001b3; };
+		for (std::size_t id = 0; id < graph.states.size(); ++id) {
+			for (const ErasedResponse& response : graph.responses_of(graph.states[id])) {
+				mix(id);
+				mix(response.anyRead ? ~std::uint64_t{0} : numbering.id_of(response.read));
+			}
+		}
+		return hash;
+	}
+
+	template <typename Descriptor>
+	consteval std::span<const std::uint64_t> get_response_profile() {
+		constexpr std::span<const std::uint64_t> profile = response_profile<Descriptor>;
+		if (!profile.empty() && (profile.size() != machine_graph<Descriptor>.responses.size() || response_profile_signature<Descriptor> != get_profile_signature<Descriptor>()))
+			throw "Response profile does not match the machine, regenerate it with write_profile";
+		return profile;
+	}
+
+	// Response indices of a state in matching order
+	// Responses before the first any symbol read are sorted by descending hits, each reads a distinct symbol so first match semantics are preserved
+	// A Response repeating an earlier read is shadowed by it, which is decided from the graph rather than trusted to the profile, so it stays
+	// after every distinct read; the any symbol read and anything after it stay last
+	template <typename Descriptor>
+	consteval std::span<const std::size_t> get_response_order(std::size_t id) {
+		constexpr MachineGraph graph = machine_graph<Descriptor>;
+		constexpr std::span<const std::uint64_t> profile = get_response_profile<Descriptor>();
+		const ErasedState& state = graph.states[id];
+
+		std::vector<std::size_t> order(state.responseCount);
+		std::iota(order.begin(), order.end(), state.firstResponse);
+		if (!profile.empty()) {
+			auto specific = std::ranges::find_if(order, [&](std::size_t i) { return graph.responses[i].anyRead; });
+			std::vector<std::size_t> distinct, repeated;
+			for (auto it = order.begin(); it != specific; ++it) {
+				const bool repeat = std::ranges::any_of(order.begin(), it, [&](std::size_t i) { return graph.responses[i].read == graph.responses[*it].read; });
+				(repeat ? repeated : distinct).push_back(*it);
+			}
+			std::ranges::stable_sort(distinct, std::ranges::greater{}, [&](std::size_t i) { return profile[i]; });
+			std::ranges::copy(repeated, std::ranges::copy(distinct, order.begin()).out);
+		}
+		return std::define_static_array(order);
+	}
+
+	template <typename Descriptor, std::size_t id>
+	inline constexpr std::span<const std::size_t> response_order = get_response_order<Descriptor>(id);
+
+	// State IDs ordered by descending total hits, so generated tables keep hot states contiguous
+	template <typename Descriptor>
+	consteval std::span<const std::size_t> get_state_layout() {
+		constexpr MachineGraph graph = machine_graph<Descriptor>;
+		constexpr std::span<const std::uint64_t> profile = get_response_profile<Descriptor>();
+
+		std::vector<std::size_t> layout(graph.states.size());
+		std::iota(layout.begin(), layout.end(), 0);
+		if (!profile.empty()) {
+			auto hits = [&](std::size_t id) {
+				const ErasedState& state = graph.states[id];
+				return std::reduce(profile.begin() + state.firstResponse, profile.begin() + state.firstResponse + state.responseCount, std::uint64_t{0});
+			};
+			std::ranges::stable_sort(layout, std::ranges::greater{}, hits);
+		}
+		return std::define_static_array(layout);
+	}
+
+	template <typename Descriptor>
+	inline constexpr std::span<const std::size_t> state_layout = get_state_layout<Descriptor>();
+
+	// Position of each state ID in state_layout
+	template <typename Descriptor>
+	inline constexpr auto state_rank = [] {
+		std::array<std::size_t, machine_graph<Descriptor>.states.size()> rank;
+		for (std::size_t i = 0; i < state_layout<Descriptor>.size(); ++i)
+			rank[state_layout<Descriptor>[i]] = i;
+		return rank;
+	}();
+};
+
+// Writes hits (collected with TuringMachine::set_profile) as an include file specialising response_profile<Descriptor>
+// The descriptor is named as spelled in Descriptor's declaration, and must be visible where the file is included
+template <typename Descriptor>
+void write_profile(std::ostream& out, std::span<const std::uint64_t> hits) {
+	static constexpr impl::MachineGraph graph = impl::machine_graph<Descriptor>;
+	static constexpr const char* name = std::define_static_string(display_string_of(^^Descriptor));
+	static constexpr auto stateNames = [] {
+		std::array<const char*, graph.states.size()> names;
+		for (std::size_t i = 0; i < names.size(); ++i)
+			names[i] = impl::qualified_state_name(graph.states[i].enumerator);
+		return names;
+	}();
+
+	std::println(out, "// Response profile for {}, generated by write_profile", name);
+	std::println(out, "#include \"profile.hpp\"");
+	std::println(out);
+	std::println(out, "template <>");
+	std::println(out, "inline constexpr std::span<const std::uint64_t> response_profile<{}> = std::define_static_array(std::array<std::uint64_t, {}>{{", name, graph.responses.size());
+	for (std::size_t id = 0; id < graph.states.size(); ++id) {
+		const impl::ErasedState& state = graph.states[id];
+		if (state.responseCount == 0)
+			continue;
+		std::print(out, "\t/* {} */", stateNames[id]);
+		for (std::size_t i = state.firstResponse; i < state.firstResponse + state.responseCount; ++i)
+			std::print(out, " {},", i < hits.size() ? hits[i] : 0);
+		std::println(out);
+	}
+	std::println(out, "}});");
+	std::println(out);
+	std::println(out, "template <>");
+	std::println(out, "inline constexpr std::uint64_t response_profile_signature<{}> = {:#x};", name, impl::get_profile_signature<Descriptor>());
+}
+
+#endif // PROFILE_HPP
@@ -0,0 +1,140 @@
+#ifndef REPLAY_LOG_HPP
+#define REPLAY_LOG_HPP
+
+#include "decl_components.hpp"
+
+#include <vector>
+#include <optional>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+// Undo log of an execution, one variable length entry per transition plus periodic keyframes (full snapshots)
+// Entries are [overwritten symbol][previous state][header byte], the header is last so entries can be popped from the back
+// A transition which neither changes its cell nor its state costs a single byte
+template <typename SymbolId, typename StateId, typename Snapshot>
+class ReplayLog {
+public:
+	struct Entry {
+		// Action::Halt for the halting transition, which neither moves nor follows its link
+		Action action;
+		Link link;
+		// The head moved right onto a newly appended blank cell
+		bool grew;
+		std::optional<SymbolId> overwritten;
+		std::optional<StateId> previous;
+	};
+
+	struct Keyframe {
+		std::size_t step;
+		// Log size when the snapshot was taken
+		std::size_t offset;
+		Snapshot snapshot;
+	};
+
+private:
+	// Header bits: action (2), link (2), grew, overwritten, previous
+	static constexpr std::uint8_t grewBit = 1 << 4;
+	static constexpr std::uint8_t overwrittenBit = 1 << 5;
+	static constexpr std::uint8_t previousBit = 1 << 6;
+
+	std::vector<std::uint8_t> bytes_;
+	std::vector<Keyframe> keyframes_;
+	std::size_t interval_;
+
+	template <typename T>
+	void write(T x) {
+		for (std::size_t i = 0; i < sizeof(T); ++i)
+			bytes_.push_back(static_cast<std::uint8_t>(x >> (8 * i)));
+	}
+
+	template <typename T>
+	T read_back() {
+		T x = 0;
+		for (std::size_t i = sizeof(T); i-- > 0;) {
+			x |= static_cast<T>(static_cast<T>(bytes_.back()) << (8 * i));
+			bytes_.pop_back();
+		}
+		return x;
+	}
+
+public:
+	explicit ReplayLog(std::size_t keyframeInterval)
+		: interval_(std::max<std::size_t>(keyframeInterval, 1)) {}
+
+	void push(const Entry& entry) {
+		std::uint8_t header = static_cast<std::uint8_t>(static_cast<unsigned>(entry.action) | static_cast<unsigned>(entry.link) << 2);
+		if (entry.grew)
+			header |= grewBit;
+		if (entry.overwritten) {
+			write(*entry.overwritten);
+			header |= overwrittenBit;
+		}
+		if (entry.previous) {
+			write(*entry.previous);
+			header |= previousBit;
+		}
+		bytes_.push_back(header);
+	}
+
+	// Removes the last entry, and any keyframe taken after it
+	Entry pop() {
+		const std::uint8_t header = bytes_.back();
+		bytes_.pop_back();
+
+		Entry entry{static_cast<Action>(header & 0x3), static_cast<Link>((header >> 2) & 0x3), (header & grewBit) != 0, std::nullopt, std::nullopt};
+		if (header & previousBit)
+			entry.previous = read_back<StateId>();
+		if (header & overwrittenBit)
+			entry.overwritten = read_back<SymbolId>();
+
+		while (!keyframes_.empty() && keyframes_.back().offset > bytes_.size())
+			keyframes_.pop_back();
+		return entry;
+	}
+
+	// Appends the entries (not the keyframes) of a log recorded from where this one ends
+	void append(const ReplayLog& other) {
+		bytes_.insert(bytes_.end(), other.bytes_.begin(), other.bytes_.end());
+	}
+
+	[[nodiscard]] bool keyframe_due(std::size_t step) const {
+		return keyframes_.empty() || step - keyframes_.back().step >= interval_;
+	}
+
+	void add_keyframe(std::size_t step, Snapshot snapshot) {
+		keyframes_.push_back(Keyframe{step, bytes_.size(), std::move(snapshot)});
+	}
+
+	// Latest keyframe at or before step, or nullptr if step precedes the log
+	[[nodiscard]] const Keyframe* keyframe_before(std::size_t step) const {
+		auto it = std::ranges::upper_bound(keyframes_, step, {}, &Keyframe::step);
+		return it == keyframes_.begin() ? nullptr : &*(it - 1);
+	}
+
+	// Discards everything recorded after keyframe
+	void rewind(const Keyframe& keyframe) {
+		bytes_.resize(keyframe.offset);
+		keyframes_.erase(keyframes_.begin() + (&keyframe - keyframes_.data()) + 1, keyframes_.end());
+	}
+
+	void clear() {
+		bytes_.clear();
+		keyframes_.clear();
+	}
+
+	[[nodiscard]] bool empty() const noexcept {
+		return bytes_.empty();
+	}
+
+	// Size of the undo entries, excluding keyframes
+	[[nodiscard]] std::size_t bytes() const noexcept {
+		return bytes_.size();
+	}
+
+	[[nodiscard]] std::size_t keyframes() const noexcept {
+		return keyframes_.size();
+	}
+};
+
+#endif // REPLAY_LOG_HPP
@@ -0,0 +1,466 @@
+#ifndef RUNTIME_TABLE_HPP
+#define RUNTIME_TABLE_HPP
+
+#include "utility.hpp"
+#include "decl_components.hpp"
+#include "machine_graph.hpp"
+#include "symbol_table.hpp"
+#include "profile.hpp"
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <span>
+#include <meta>
+#include <optional>
+#include <stdexcept>
+#include <istream>
+#include <ostream>
+#include <ranges>
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <format>
+#include <limits>
+
+struct RuntimeTransition {
+	std::uint32_t next;
+	// Only meaningful for Link::Call
+	std::uint32_t returnTo;
+	std::uint16_t write;
+	Action action;
+	Link link;
+	// False when the transition writes back the read symbol
+	bool writes;
+	// False when no Response matches
+	bool defined;
+};
+
+// Machine table loaded at runtime, a dense [state][symbol] transition table
+// Symbol 0 is the blank symbol
+struct RuntimeTable {
+	std::vector<std::string> states;
+	std::vector<std::string> symbols;
+	std::uint32_t start = 0;
+	// Bound on nested Link::Call depth, Config::maxCallDepth of the exported machine
+	std::uint32_t maxCallDepth = 64;
+	std::vector<RuntimeTransition> transitions;
+
+	[[nodiscard]] const RuntimeTransition& at(std::uint32_t state, std::uint16_t symbol) const {
+		return transitions[state * symbols.size() + symbol];
+	}
+
+	[[nodiscard]] std::optional<std::uint16_t> symbol_id(std::string_view name) const {
+		auto it = std::ranges::find(symbols, name);
+		if (it == symbols.end())
+			return std::nullopt;
+		return static_cast<std::uint16_t>(it - symbols.begin());
+	}
+
+	[[nodiscard]] std::optional<std::uint32_t> state_id(std::string_view name) const {
+		auto it = std::ranges::find(states, name);
+		if (it == states.end())
+			return std::nullopt;
+		return static_cast<std::uint32_t>(it - states.begin());
+	}
+};
+
+namespace impl {
+	// Symbols are named by their enumerator, qualified by their enum if more than one alphabet is reachable
+	template <typename Descriptor>
+	consteval std::span<const char* const> get_exported_symbol_names() {
+		constexpr SymbolNumbering numbering = SymbolTable<Descriptor>::numbering;
+		const bool qualify = get_reachable_states_and_symbols<Descriptor>().symbols.data.size() > 1;
+
+		std::vector<const char*> names;
+		for (std::meta::info symbol : numbering.symbols) {
+			std::meta::info type = type_of(symbol);
+			std::meta::info enumerator{};
+			for (std::meta::info e : enumerators_of(type)) {
+				if (constant_of(e) == symbol)
+					enumerator = e;
+			}
+			std::string name(identifier_of(enumerator));
+			if (qualify)
+				name = std::string(display_string_of(type)) + "::" + name;
+			names.push_back(std::define_static_string(name));
+		}
+		return std::define_static_array(names);
+	}
+
+	// States are exported in state_layout order, so profiled machines keep their hot rows together
+	template <typename Descriptor>
+	consteval std::span<const char* const> get_exported_state_names() {
+		std::vector<const char*> names;
+		for (std::size_t id : state_layout<Descriptor>)
+			names.push_back(qualified_state_name(machine_graph<Descriptor>.states[id].enumerator));
+		return std::define_static_array(names);
+	}
+
+	template <typename Descriptor>
+	consteval std::uint32_t exported_state_id(std::meta::info enumerator) {
+		return static_cast<std::uint32_t>(state_rank<Descriptor>[machine_graph<Descriptor>.index_of(enumerator)]);
+	}
+
+	// First matching Response for every (state, symbol) pair of the reachable graph
+	template <typename Descriptor>
+	consteval std::span<const RuntimeTransition> get_exported_transitions() {
+		constexpr MachineGraph graph = machine_graph<Descriptor>;
+		constexpr SymbolNumbering numbering = SymbolTable<Descriptor>::numbering;
+
+		std::vector<RuntimeTransition> transitions;
+		for (std::size_t id : state_layout<Descriptor>) {
+			const ErasedState& state = graph.states[id];
+			for (std::size_t symbol = 0; symbol < numbering.symbols.size(); ++symbol) {
+				const ErasedResponse* response = numbering.first_match(graph, state, symbol);
+				if (response == nullptr) {
+					transitions.push_back(RuntimeTransition{});
+					continue;
+				}
+
+				transitions.push_back(RuntimeTransition{
+					.next = response->link == Link::Return ? 0 : exported_state_id<Descriptor>(response->next),
+					.returnTo = response->link == Link::Call ? exported_state_id<Descriptor>(response->returnTo) : 0,
+					.write = static_cast<std::uint16_t>(response->anyWrite ? symbol : numbering.id_of(response->write)),
+					.action = response->action,
+					.link = response->link,
+					.writes = !response->anyWrite,
+					.defined = true
+				});
+			}
+		}
+		return std::define_static_array(transitions);
+	}
+
+	inline void write_u32(std::ostream& out, std::uint32_t x) {
+		for (int i = 0; i < 4; ++i)
+			out.put(static_cast<char>((x >> (8 * i)) & 0xFF));
+	}
+
+	inline std::uint32_t read_u32(std::istream& in) {
+		std::uint32_t x = 0;
+		for (int i = 0; i < 4; ++i) {
+			int c = in.get();
+			if (c == std::istream::traits_type::eof())
+				throw std::runtime_error("Unexpected end of machine table");
+			x |= static_cast<std::uint32_t>(c) << (8 * i);
+		}
+		return x;
+	}
+
+	inline void write_string(std::ostream& out, std::string_view str) {
+		write_u32(out, static_cast<std::uint32_t>(str.size()));
+		out.write(str.data(), static_cast<std::streamsize>(str.size()));
+	}
+
+	// Read in pieces, so a corrupt length runs into the end of the stream instead of allocating up front
+	inline std::string read_string(std::istream& in) {
+		constexpr std::size_t piece = 4096;
+		const std::uint32_t length = read_u32(in);
+		std::string str;
+		while (str.size() < length) {
+			const std::size_t offset = str.size();
+			str.resize(offset + std::min<std::size_t>(piece, length - offset));
+			if (!in.read(str.data() + offset, static_cast<std::streamsize>(str.size() - offset)))
+				throw std::runtime_error("Unexpected end of machine table");
+		}
+		return str;
+	}
+
+	// Bytes left in a seekable stream, nullopt if the stream (e.g. a pipe) can't tell
+	inline std::optional<std::uint64_t> remaining_bytes(std::istream& in) {
+		const std::istream::pos_type pos = in.tellg();
+		if (pos == std::istream::pos_type(-1))
+			return std::nullopt;
+		in.seekg(0, std::ios::end);
+		const std::istream::pos_type end = in.tellg();
+		in.clear();
+		in.seekg(pos);
+		if (end == std::istream::pos_type(-1) || end < pos)
+			return std::nullopt;
+		return static_cast<std::uint64_t>(end - pos);
+	}
+
+	inline constexpr std::uint32_t tableMagic = 0x544D5444; // "DTMT"
+	inline constexpr std::uint32_t tableVersion = 2;
+};
+
+// Dumps the reachable graph of a reflected machine, Responses are resolved to a dense table so first match order is preserved
+template <typename Descriptor>
+[[nodiscard]] RuntimeTable export_table() {
+	constexpr auto states = impl::get_exported_state_names<Descriptor>();
+	constexpr auto symbols = impl::get_exported_symbol_names<Descriptor>();
+	constexpr auto transitions = impl::get_exported_transitions<Descriptor>();
+	constexpr auto start = impl::exported_state_id<Descriptor>(impl::get_start_state<Descriptor>());
+	constexpr auto maxCallDepth = [] {
+		using State = [:impl::get_state_enum<Descriptor>():];
+		using Symbol = [:impl::get_symbol<Descriptor>():];
+		return annotation_of<Config<Symbol>>(dealias(^^State))->maxCallDepth;
+	}();
+
+	return RuntimeTable{
+		.states = std::vector<std::string>(states.begin(), states.end()),
+		.symbols = std::vector<std::string>(symbols.begin(), symbols.end()),
+		.start = start,
+		.maxCallDepth = static_cast<std::uint32_t>(maxCallDepth),
+		.transitions = std::vector<RuntimeTransition>(transitions.begin(), transitions.end())
+	};
+}
+
+// Binary format (little endian):
+//   u32 magic, u32 version, u32 state count, u32 symbol count, u32 start state, u32 max call depth (from version 2)
+//   state names, symbol names (u32 length + bytes each)
+//   transitions, state major (u32 next, u32 returnTo, u32 write, u32 action | link << 8 | writes << 16 | defined << 24)
+inline void write_table(std::ostream& out, const RuntimeTable& table) {
+	impl::write_u32(out, impl::tableMagic);
+	impl::write_u32(out, impl::tableVersion);
+	impl::write_u32(out, static_cast<std::uint32_t>(table.states.size()));
+	impl::write_u32(out, static_cast<std::uint32_t>(table.symbols.size()));
+	impl::write_u32(out, table.start);
+	impl::write_u32(out, table.maxCallDepth);
+	for (const auto& name : table.states)
+		impl::write_string(out, name);
+	for (const auto& name : table.symbols)
+		impl::write_string(out, name);
+	for (const RuntimeTransition& t : table.transitions) {
+		impl::write_u32(out, t.next);
+		impl::write_u32(out, t.returnTo);
+		impl::write_u32(out, t.write);
+		impl::write_u32(out, static_cast<std::uint32_t>(t.action) | static_cast<std::uint32_t>(t.link) << 8 | std::uint32_t{t.writes} << 16 | std::uint32_t{t.defined} << 24);
+	}
+}
+
+[[nodiscard]] inline RuntimeTable read_table(std::istream& in) {
+	if (impl::read_u32(in) != impl::tableMagic)
+		throw std::runtime_error("Not a machine table");
+	const std::uint32_t version = impl::read_u32(in);
+	if (version == 0 || version > impl::tableVersion)
+		throw std::runtime_error("Unsupported machine table version");
+
+	RuntimeTable table;
+	const std::uint32_t stateCount = impl::read_u32(in);
+	const std::uint32_t symbolCount = impl::read_u32(in);
+	table.start = impl::read_u32(in);
+	// Version 1 tables predate the call depth and used the default
+	if (version >= 2)
+		table.maxCallDepth = impl::read_u32(in);
+	if (symbolCount == 0 || symbolCount > 65536 || table.start >= stateCount)
+		throw std::runtime_error("Malformed machine table");
+
+	// Both counts are below 2^32 and symbols at most 2^16, so the product can't overflow 64 bits, but may not fit in memory
+	const std::uint64_t transitionCount = std::uint64_t{stateCount} * symbolCount;
+	if (transitionCount > std::numeric_limits<std::size_t>::max() / sizeof(RuntimeTransition))
+		throw std::runtime_error("Malformed machine table");
+	// Every name takes at least 4 bytes and every transition 16, so counts the rest of the stream can't hold are rejected before anything is sized from them
+	if (const std::optional<std::uint64_t> remaining = impl::remaining_bytes(in)) {
+		const std::uint64_t names = (std::uint64_t{stateCount} + symbolCount) * 4;
+		if (transitionCount > *remaining / 16 || names > *remaining - transitionCount * 16)
+			throw std::runtime_error("Malformed machine table");
+	}
+
+	// Streams which can't report their size are still only grown as entries are actually read
+	for (std::uint32_t i = 0; i < stateCount; ++i)
+		table.states.push_back(impl::read_string(in));
+	for (std::uint32_t i = 0; i < symbolCount; ++i)
+		table.symbols.push_back(impl::read_string(in));
+
+	for (std::uint64_t i = 0; i < transitionCount; ++i) {
+		RuntimeTransition& t = table.transitions.emplace_back();
+		t.next = impl::read_u32(in);
+		t.returnTo = impl::read_u32(in);
+		t.write = static_cast<std::uint16_t>(impl::read_u32(in));
+		std::uint32_t flags = impl::read_u32(in);
+		t.action = static_cast<Action>(flags & 0xFF);
+		t.link = static_cast<Link>((flags >> 8) & 0xFF);
+		t.writes = (flags >> 16) & 1;
+		t.defined = (flags >> 24) & 1;
+
+		if (t.defined && (t.next >= table.states.size() || t.returnTo >= table.states.size() || t.write >= table.symbols.size()
+			|| t.action > Action::Halt || t.link > Link::Return))
+			throw std::runtime_error("Malformed machine table");
+	}
+	return table;
+}
+
+// Parses a Turing style text table, one transition per line of space or tab separated fields:
+//   State Symbol Actions NextState
+// Symbol may be * to match any symbol, transitions are matched from top to bottom as in RL
+// Actions is a comma separated list of P<symbol> (print), E (erase), L, R, N (no move) or H (halt),
+// a list with several moves is split into anonymous intermediate states (e.g. P1,R,PZ), H must be the last action
+// ; starts a comment, `start <state>` sets the start state (defaulting to the first state)
+// and `blank <symbol>` names the blank symbol (defaulting to _)
+[[nodiscard]] inline RuntimeTable parse_table(std::string_view text) {
+	struct Op {
+		std::optional<std::string> write;
+		Action action;
+	};
+	struct Row {
+		std::string state;
+		std::optional<std::string> read;
+		std::vector<Op> ops;
+		std::string next;
+		std::size_t line;
+	};
+
+	std::vector<Row> rows;
+	std::optional<std::string> start;
+	std::size_t startLine = 0;
+	std::string blank = "_";
+
+	std::size_t lineNumber = 0;
+	for (auto lineRange : text | std::views::split('\n')) {
+		++lineNumber;
+		std::string_view line(lineRange.begin(), lineRange.end());
+		line = line.substr(0, line.find(';'));
+
+		constexpr std::string_view whitespace = " \t\r";
+		std::vector<std::string> tokens;
+		for (std::size_t begin = line.find_first_not_of(whitespace); begin != std::string_view::npos; begin = line.find_first_not_of(whitespace, begin)) {
+			const std::size_t end = std::min(line.find_first_of(whitespace, begin), line.size());
+			tokens.emplace_back(line.substr(begin, end - begin));
+			begin = end;
+		}
+		if (tokens.empty())
+			continue;
+
+		auto error = [lineNumber](std::string_view message) {
+			return std::runtime_error(std::format("Line {}: {}", lineNumber, message));
+		};
+
+		if (tokens[0] == "start" || tokens[0] == "blank") {
+			if (tokens.size() != 2)
+				throw error("Expected a single argument");
+			if (tokens[0] == "start") {
+				start = tokens[1];
+				startLine = lineNumber;
+			}
+			else
+				blank = tokens[1];
+			continue;
+		}
+		if (tokens.size() != 4)
+			throw error("Expected State Symbol Actions NextState");
+
+		Row row{tokens[0], std::nullopt, {}, tokens[3], lineNumber};
+		if (tokens[1] != "*")
+			row.read = tokens[1];
+
+		// Each op is one transition: an optional print followed by a move
+		Op op{std::nullopt, Action::None};
+		for (auto opRange : std::string_view(tokens[2]) | std::views::split(',')) {
+			std::string_view token(opRange.begin(), opRange.end());
+			if (token.empty())
+				throw error("Empty action");
+			if (!row.ops.empty() && row.ops.back().action == Action::Halt)
+				throw error(std::format("Action '{}' follows H and would never be performed", token));
+
+			if ((token.front() == 'P' && token.size() > 1) || token == "E") {
+				// Two prints in a row are two transitions
+				if (op.write)
+					row.ops.push_back(std::exchange(op, Op{std::nullopt, Action::None}));
+				op.write = token == "E" ? blank : std::string(token.substr(1));
+				continue;
+			}
+
+			if (token == "L")
+				op.action = Action::Left;
+			else if (token == "R")
+				op.action = Action::Right;
+			else if (token == "N")
+				op.action = Action::None;
+			else if (token == "H")
+				op.action = Action::Halt;
+			else
+				throw error(std::format("Unknown action '{}'", token));
+			row.ops.push_back(std::exchange(op, Op{std::nullopt, Action::None}));
+		}
+		if (op.write || row.ops.empty())
+			row.ops.push_back(op);
+
+		rows.push_back(std::move(row));
+	}
+	if (rows.empty())
+		throw std::runtime_error("Machine table has no transitions");
+
+	RuntimeTable table;
+	auto intern = [](std::vector<std::string>& names, const std::string& name) {
+		auto it = std::ranges::find(names, name);
+		if (it != names.end())
+			return static_cast<std::uint32_t>(it - names.begin());
+		names.push_back(name);
+		return static_cast<std::uint32_t>(names.size() - 1);
+	};
+
+	// Number every named state and symbol before building the dense table, so any symbol rows cover symbols first seen later
+	table.symbols.push_back(blank);
+	for (const Row& row : rows) {
+		intern(table.states, row.state);
+		if (row.read)
+			intern(table.symbols, *row.read);
+		for (const Op& op : row.ops) {
+			if (op.write)
+				intern(table.symbols, *op.write);
+		}
+	}
+	for (const Row& row : rows)
+		intern(table.states, row.next);
+	if (table.symbols.size() > 65536)
+		throw std::runtime_error("Too many symbols");
+
+	const std::size_t namedStates = table.states.size();
+	std::vector<std::vector<RuntimeTransition>> grid(namedStates, std::vector<RuntimeTransition>(table.symbols.size()));
+
+	for (const Row& row : rows) {
+		const std::uint32_t state = intern(table.states, row.state);
+		const std::uint32_t next = intern(table.states, row.next);
+
+		// Anonymous states perform the remaining ops unconditionally
+		std::uint32_t entry = state;
+		for (std::size_t i = 0; i < row.ops.size(); ++i) {
+			const Op& op = row.ops[i];
+			const bool last = i + 1 == row.ops.size();
+
+			std::uint32_t target = next;
+			if (!last) {
+				table.states.push_back(std::format("{}#{}.{}", row.state, row.line, i + 1));
+				grid.emplace_back(table.symbols.size());
+				target = static_cast<std::uint32_t>(table.states.size() - 1);
+			}
+
+			for (std::size_t symbol = 0; symbol < table.symbols.size(); ++symbol) {
+				// The first op is conditional on the read symbol, anonymous states match anything
+				if (i == 0 && row.read && table.symbols[symbol] != *row.read)
+					continue;
+				RuntimeTransition& t = grid[entry][symbol];
+				if (t.defined)
+					continue;
+				t = RuntimeTransition{
+					.next = target,
+					.returnTo = 0,
+					.write = static_cast<std::uint16_t>(op.write ? intern(table.symbols, *op.write) : symbol),
+					.action = op.action,
+					.link = Link::Jump,
+					.writes = op.write.has_value(),
+					.defined = true
+				};
+			}
+			if (op.action == Action::Halt)
+				break;
+			entry = target;
+		}
+	}
+
+	if (start) {
+		const std::optional<std::uint32_t> id = table.state_id(*start);
+		if (!id || *id >= namedStates)
+			throw std::runtime_error(std::format("Line {}: Start state '{}' does not appear in any transition", startLine, *start));
+		table.start = *id;
+	}
+	if (table.states.size() > grid.size())
+		grid.resize(table.states.size(), std::vector<RuntimeTransition>(table.symbols.size()));
+	for (auto& row : grid)
+		table.transitions.insert(table.transitions.end(), row.begin(), row.end());
+	return table;
+}
+
+#endif // RUNTIME_TABLE_HPP
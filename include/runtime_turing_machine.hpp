@@ -0,0 +1,231 @@
+#ifndef RUNTIME_TURING_MACHINE_HPP
+#define RUNTIME_TURING_MACHINE_HPP
+
+#include "decl_components.hpp"
+#include "chunked_tape.hpp"
+#include "execution_stats.hpp"
+#include "runtime_table.hpp"
+#include "packed_table.hpp"
+
+#include <vector>
+#include <span>
+#include <optional>
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <utility>
+#include <cstdint>
+
+// Executes a RuntimeTable with the same tape representation and step semantics as TuringMachine
+// The table is packed on construction (see pack_table), for reflected machines pass table_layout<Descriptor> to use the layout chosen at compile time
+// Tables too large to pack run from their RuntimeTransitions directly
+class RuntimeTuringMachine {
+	RuntimeTable table_;
+	PackedTable packed_;
+	ChunkedTape<std::uint16_t> tape_;
+	std::size_t head_ = 0;
+	std::uint32_t state_ = 0;
+	std::vector<std::uint32_t> callStack_;
+	std::size_t steps_ = 0;
+	ExecutionStatus status_ = ExecutionStatus::Running;
+	std::size_t minHead_ = 0;
+	std::size_t maxHead_ = 0;
+	std::chrono::nanoseconds elapsed_{};
+	std::vector<std::uint16_t> output_;
+
+	bool stop(ExecutionStatus status) {
+		status_ = status;
+		return true;
+	}
+
+	// Transition for the current state and symbol, unpacked from whichever representation the layout reads
+	template <TableLayout layout>
+	RuntimeTransition fetch() const {
+		if constexpr (layout == TableLayout::Unpacked)
+			return table_.at(state_, tape_[head_]);
+		else {
+			const PackedEntry t = packed_.at<layout>(state_, tape_[head_]);
+			RuntimeTransition out{t.next(), 0, t.write(), t.action(), t.link(), t.writes(), t.defined()};
+			if (t.link() == Link::Call) {
+				const PackedCall& call = packed_.calls[t.next()];
+				out.next = call.next;
+				out.returnTo = call.returnTo;
+			}
+			return out;
+		}
+	}
+
+	template <TableLayout layout>
+	bool step_impl() {
+		const RuntimeTransition t = fetch<layout>();
+		if (!t.defined)
+			return stop(ExecutionStatus::MissingTransition);
+		const Action action = t.action;
+		const Link link = t.link;
+		if (action == Action::Left && head_ == 0)
+			return stop(ExecutionStatus::TapeUnderflow);
+		if (action != Action::Halt) {
+			if (link == Link::Call && callStack_.size() == table_.maxCallDepth)
+				return stop(ExecutionStatus::CallStackOverflow);
+			if (link == Link::Return && callStack_.empty())
+				return stop(ExecutionStatus::CallStackUnderflow);
+		}
+		++steps_;
+
+		if (t.writes)
+			tape_.set(head_, t.write);
+
+		switch (action) {
+		case Action::Left:
+			--head_;
+			break;
+		case Action::Right:
+			if (++head_ == tape_.size())
+				tape_.push_back(0);
+		case Action::None:
+			break;
+		case Action::Halt:
+			return stop(ExecutionStatus::Halted);
+		default:
+			std::unreachable();
+		}
+
+		switch (link) {
+		case Link::Jump:
+			state_ = t.next;
+			break;
+		case Link::Call:
+			callStack_.push_back(t.returnTo);
+			state_ = t.next;
+			break;
+		case Link::Return:
+			state_ = callStack_.back();
+			callStack_.pop_back();
+			break;
+		default:
+			std::unreachable();
+		}
+		return false;
+	}
+
+	template <TableLayout layout>
+	bool run_impl(std::size_t quantum) {
+		const auto begin = std::chrono::steady_clock::now();
+
+		std::size_t minHead = head_;
+		std::size_t maxHead = head_;
+		bool stopped = status_ != ExecutionStatus::Running;
+		for (std::size_t i = 0; i < quantum && !stopped; ++i) {
+			stopped = step_impl<layout>();
+			minHead = std::min(minHead, head_);
+			maxHead = std::max(maxHead, head_);
+		}
+
+		minHead_ = std::min(minHead, minHead_);
+		maxHead_ = std::max(maxHead, maxHead_);
+		elapsed_ += std::chrono::steady_clock::now() - begin;
+		return stopped;
+	}
+
+public:
+	explicit RuntimeTuringMachine(RuntimeTable table, std::optional<TableLayout> layout = std::nullopt)
+		: table_(std::move(table)), packed_(pack_table(table_, layout)) {}
+
+	void reset() {
+		state_ = table_.start;
+		head_ = 0;
+		callStack_.clear();
+		steps_ = 0;
+		status_ = ExecutionStatus::Running;
+		minHead_ = maxHead_ = 0;
+		elapsed_ = {};
+	}
+
+	// Throws if input holds a symbol ID outside the table, the step loop indexes the table with cells unchecked
+	void load(std::span<const std::uint16_t> input) {
+		if (std::ranges::any_of(input, [&](std::uint16_t symbol) { return symbol >= table_.symbols.size(); }))
+			throw std::runtime_error("Input symbol is not part of the machine table");
+		tape_.assign(input);
+		if (tape_.size() == 0)
+			tape_.push_back(0);
+		reset();
+	}
+
+	// Performs a single transition, returns true once the machine has stopped (halted or faulted, see status())
+	bool step() {
+		switch (packed_.layout) {
+		case TableLayout::Dense:
+			return step_impl<TableLayout::Dense>();
+		case TableLayout::Compressed:
+			return step_impl<TableLayout::Compressed>();
+		case TableLayout::Hashed:
+			return step_impl<TableLayout::Hashed>();
+		case TableLayout::Unpacked:
+			return step_impl<TableLayout::Unpacked>();
+		default:
+			std::unreachable();
+		}
+	}
+
+	// Runs until the machine stops or quantum more transitions have been performed, returns true once stopped
+	// A quantum of 0 is treated as 1, so every call makes progress
+	bool run(std::size_t quantum) {
+		quantum = std::max<std::size_t>(quantum, 1);
+		switch (packed_.layout) {
+		case TableLayout::Dense:
+			return run_impl<TableLayout::Dense>(quantum);
+		case TableLayout::Compressed:
+			return run_impl<TableLayout::Compressed>(quantum);
+		case TableLayout::Hashed:
+			return run_impl<TableLayout::Hashed>(quantum);
+		case TableLayout::Unpacked:
+			return run_impl<TableLayout::Unpacked>(quantum);
+		default:
+			std::unreachable();
+		}
+	}
+
+	// The tape, statistics and status so far, the tape is a copy valid until the next call
+	[[nodiscard]] ExecutionResult<const std::uint16_t, std::uint32_t> result() {
+		ExecutionStats stats{
+			.steps = steps_,
+			.minHead = minHead_,
+			.maxHead = maxHead_,
+			.tapeHighWater = tape_.size(),
+			.tapeBytes = tape_.chunks() * decltype(tape_)::chunk_size * sizeof(std::uint16_t),
+			.duration = elapsed_
+		};
+
+		tape_.copy_to(output_);
+		return ExecutionResult<const std::uint16_t, std::uint32_t>{output_, stats, status_, state_, output_[head_]};
+	}
+
+	[[nodiscard]] ExecutionResult<const std::uint16_t, std::uint32_t> execute(std::span<const std::uint16_t> input) {
+		load(input);
+		while (!run(std::numeric_limits<std::size_t>::max()));
+		return result();
+	}
+
+	[[nodiscard]] const RuntimeTable& table() const noexcept {
+		return table_;
+	}
+
+	[[nodiscard]] const PackedTable& packed() const noexcept {
+		return packed_;
+	}
+
+	[[nodiscard]] std::uint32_t state() const noexcept {
+		return state_;
+	}
+
+	[[nodiscard]] std::size_t steps() const noexcept {
+		return steps_;
+	}
+
+	[[nodiscard]] ExecutionStatus status() const noexcept {
+		return status_;
+	}
+};
+
+#endif // RUNTIME_TURING_MACHINE_HPP
@@ -0,0 +1,179 @@
+#ifndef SCHEDULER_HPP
+#define SCHEDULER_HPP
+
+#include <coroutine>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <stop_token>
+#include <future>
+#include <exception>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+
+// Coroutine which runs a machine one quantum at a time, suspending in between
+// Starts suspended, each resume() runs a single quantum
+class ExecutionTask {
+public:
+	struct promise_type {
+		ExecutionTask get_return_object() {
+			return ExecutionTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+		}
+
+		std::suspend_always initial_suspend() noexcept {
+			return {};
+		}
+
+		std::suspend_always final_suspend() noexcept {
+			return {};
+		}
+
+		void return_void() noexcept {}
+
+		void unhandled_exception() {
+			throw;
+		}
+	};
+
+	ExecutionTask(ExecutionTask&& other) noexcept
+		: handle_(std::exchange(other.handle_, {})) {}
+
+	ExecutionTask& operator=(ExecutionTask&& other) noexcept {
+		if (this != &other) {
+			if (handle_)
+				handle_.destroy();
+			handle_ = std::exchange(other.handle_, {});
+		}
+		return *this;
+	}
+
+	~ExecutionTask() {
+		if (handle_)
+			handle_.destroy();
+	}
+
+	// Runs the next quantum, returns true once the machine has stopped
+	bool resume() {
+		if (!handle_.done())
+			handle_.resume();
+		return handle_.done();
+	}
+
+	[[nodiscard]] bool done() const {
+		return handle_.done();
+	}
+
+private:
+	explicit ExecutionTask(std::coroutine_handle<promise_type> handle)
+		: handle_(handle) {}
+
+	std::coroutine_handle<promise_type> handle_;
+};
+
+// Works with any machine providing run(quantum) (TuringMachine, RuntimeTuringMachine), which must already be loaded
+// The machine must outlive the task, its result() is available once the task is done
+template <typename Machine>
+ExecutionTask execute_sliced(Machine& machine, std::size_t quantum) {
+	while (!machine.run(quantum))
+		co_await std::suspend_always{};
+}
+
+// Multiplexes ExecutionTasks over a fixed pool of worker threads, one quantum at a time
+// Jobs are picked by stride scheduling, so each job receives quanta in proportion to its priority
+class Scheduler {
+	struct Job {
+		ExecutionTask task;
+		std::uint64_t stride;
+		// Virtual time of the job's next quantum, the job with the lowest pass runs next
+		std::uint64_t pass;
+		std::promise<void> done;
+	};
+
+	static constexpr std::uint64_t strideBase = std::uint64_t{1} << 20;
+
+	static constexpr auto later = [](const std::unique_ptr<Job>& a, const std::unique_ptr<Job>& b) {
+		return a->pass > b->pass;
+	};
+
+	std::mutex mutex_;
+	std::condition_variable_any ready_;
+	std::condition_variable_any idle_;
+	// Heap ordered by pass
+	std::vector<std::unique_ptr<Job>> queue_;
+	std::size_t running_ = 0;
+	// Pass of the most recently scheduled quantum
+	std::uint64_t virtualTime_ = 0;
+	// Declared last so the workers are joined before anything they use is destroyed
+	std::vector<std::jthread> workers_;
+
+	void work(std::stop_token stop) {
+		std::unique_lock lock(mutex_);
+		while (ready_.wait(lock, stop, [this] { return !queue_.empty(); })) {
+			std::ranges::pop_heap(queue_, later);
+			std::unique_ptr<Job> job = std::move(queue_.back());
+			queue_.pop_back();
+			virtualTime_ = job->pass;
+			++running_;
+			lock.unlock();
+
+			bool finished = true;
+			try {
+				finished = job->task.resume();
+				if (finished)
+					job->done.set_value();
+			}
+			catch (...) {
+				job->done.set_exception(std::current_exception());
+			}
+
+			lock.lock();
+			--running_;
+			if (!finished) {
+				job->pass += job->stride;
+				queue_.push_back(std::move(job));
+				std::ranges::push_heap(queue_, later);
+				ready_.notify_one();
+			}
+			if (queue_.empty() && running_ == 0)
+				idle_.notify_all();
+		}
+	}
+
+public:
+	explicit Scheduler(unsigned threads = std::thread::hardware_concurrency()) {
+		for (unsigned i = 0; i < std::max(threads, 1u); ++i)
+			workers_.emplace_back([this](std::stop_token stop) { work(stop); });
+	}
+
+	// Stops the workers once their current quanta finish, unfinished jobs are abandoned
+	~Scheduler() {
+		for (std::jthread& worker : workers_)
+			worker.request_stop();
+	}
+
+	// The returned future becomes ready once the task's machine has stopped
+	std::future<void> submit(ExecutionTask task, unsigned priority = 1) {
+		auto job = std::make_unique<Job>(std::move(task), strideBase / std::max(priority, 1u), 0, std::promise<void>{});
+		std::future<void> done = job->done.get_future();
+		{
+			std::scoped_lock lock(mutex_);
+			// Jobs start at the current virtual time, otherwise a new job would monopolise the workers catching up
+			job->pass = virtualTime_;
+			queue_.push_back(std::move(job));
+			std::ranges::push_heap(queue_, later);
+		}
+		ready_.notify_one();
+		return done;
+	}
+
+	// Blocks until every submitted job has finished
+	void wait() {
+		std::unique_lock lock(mutex_);
+		idle_.wait(lock, [this] { return queue_.empty() && running_ == 0; });
+	}
+};
+
+#endif // SCHEDULER_HPP
@@ -0,0 +1,89 @@
+#ifndef SWEEP_HPP
+#define SWEEP_HPP
+
+#include "decl_components.hpp"
+#include "machine_graph.hpp"
+#include "symbol_table.hpp"
+
+#include <vector>
+#include <span>
+#include <cstdint>
+
+namespace impl {
+	struct SweepTransition {
+		// Sweep state index, or global state ID if exits
+		std::uint32_t next;
+		std::uint16_t write;
+		bool writes;
+		bool defined;
+		bool exits;
+	};
+
+	// Sweep states only ever move right and jump, so from one of them the head consumes each cell exactly once
+	// until it jumps to a non sweep state; the effect of a region of tape is then a function of the entry state,
+	// which lets disjoint regions be simulated independently and stitched together afterwards
+	struct SweepTable {
+		// Sweep state index of each global state ID, -1 if it is not a sweep state
+		std::span<const std::int32_t> local;
+		// Global state ID of each sweep state
+		std::span<const std::uint32_t> global;
+		// [sweep state][symbol]
+		std::span<const SweepTransition> transitions;
+		std::size_t symbols;
+	};
+
+	template <typename Descriptor>
+	consteval SweepTable get_sweep_table() {
+		constexpr MachineGraph graph = machine_graph<Descriptor>;
+		constexpr SymbolNumbering numbering = SymbolTable<Descriptor>::numbering;
+		const std::size_t symbols = numbering.symbols.size();
+
+		auto sweeps = [&](const ErasedState& state) {
+			if (!state.hasResponseList)
+				return false;
+			for (std::size_t symbol = 0; symbol < symbols; ++symbol) {
+				const ErasedResponse* response = numbering.first_match(graph, state, symbol);
+				if (response != nullptr && (response->action != Action::Right || response->link != Link::Jump))
+					return false;
+			}
+			return true;
+		};
+
+		std::vector<std::int32_t> local(graph.states.size(), -1);
+		std::vector<std::uint32_t> global;
+		for (std::size_t id = 0; id < graph.states.size(); ++id) {
+			if (sweeps(graph.states[id])) {
+				local[id] = static_cast<std::int32_t>(global.size());
+				global.push_back(static_cast<std::uint32_t>(id));
+			}
+		}
+
+		std::vector<SweepTransition> transitions;
+		for (std::uint32_t id : global) {
+			for (std::size_t symbol = 0; symbol < symbols; ++symbol) {
+				const ErasedResponse* response = numbering.first_match(graph, graph.states[id], symbol);
+				if (response == nullptr) {
+					transitions.push_back(SweepTransition{0, 0, false, false, false});
+					continue;
+				}
+
+				const std::size_t next = graph.index_of(response->next);
+				const bool exits = local[next] < 0;
+				transitions.push_back(SweepTransition{
+					.next = static_cast<std::uint32_t>(exits ? next : local[next]),
+					.write = static_cast<std::uint16_t>(response->anyWrite ? symbol : numbering.id_of(response->write)),
+					.writes = !response->anyWrite,
+					.defined = true,
+					.exits = exits
+				});
+			}
+		}
+
+		return SweepTable{std::define_static_array(local), std::define_static_array(global), std::define_static_array(transitions), symbols};
+	}
+
+	template <typename Descriptor>
+	inline constexpr SweepTable sweep_table = get_sweep_table<Descriptor>();
+};
+
+#endif // SWEEP_HPP
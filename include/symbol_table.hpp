@@ -0,0 +1,126 @@
+#ifndef SYMBOL_TABLE_HPP
+#define SYMBOL_TABLE_HPP
+
+#include "utility.hpp"
+#include "decl_components.hpp"
+#include "machine_graph.hpp"
+
+#include <vector>
+#include <array>
+#include <meta>
+#include <span>
+#include <variant>
+#include <cstdint>
+#include <type_traits>
+#include <algorithm>
+
+namespace impl {
+	// Global symbol numbering across every reachable alphabet
+	// ID 0 is the blank cell, which every alphabet's empty symbol maps to (so a cell created by one machine is empty to every machine)
+	// The remaining symbols are numbered alphabet by alphabet in declaration order
+	struct SymbolNumbering {
+		// Reflected empty symbol of each alphabet
+		std::span<const std::meta::info> emptySymbols;
+		// Reflected symbol for each ID, symbols[0] is the entry machine's empty symbol
+		std::span<const std::meta::info> symbols;
+
+		[[nodiscard]] consteval std::size_t id_of(std::meta::info symbol) const {
+			if (std::ranges::contains(emptySymbols, symbol))
+				return 0;
+			for (std::size_t i = 1; i < symbols.size(); ++i) {
+				if (symbols[i] == symbol)
+					return i;
+			}
+			throw "Symbol is not part of any reachable alphabet";
+		}
+
+		// First Response of state matching the symbol with the given ID, or nullptr if none match
+		[[nodiscard]] consteval const ErasedResponse* first_match(const MachineGraph& graph, const ErasedState& state, std::size_t symbol) const {
+			for (const ErasedResponse& response : graph.responses_of(state)) {
+				if (response.anyRead || id_of(response.read) == symbol)
+					return &response;
+			}
+			return nullptr;
+		}
+
+		// True if some Response of state matches every symbol ID, so matching needs no fallback
+		[[nodiscard]] consteval bool covers(const MachineGraph& graph, const ErasedState& state) const {
+			for (std::size_t symbol = 0; symbol < symbols.size(); ++symbol) {
+				if (first_match(graph, state, symbol) == nullptr)
+					return false;
+			}
+			return true;
+		}
+	};
+
+	template <typename Descriptor>
+	consteval SymbolNumbering get_symbol_numbering() {
+		constexpr MachineGraph graph = machine_graph<Descriptor>;
+
+		// Machines sharing an alphabet must agree on its empty symbol
+		std::vector<std::meta::info> emptySymbols;
+		for (const ErasedState& state : graph.states) {
+			for (std::meta::info empty : emptySymbols) {
+				if (type_of(empty) == type_of(state.emptySymbol) && empty != state.emptySymbol)
+					throw "Reachable machines with the same symbol enum declare different empty symbols";
+			}
+			if (!std::ranges::contains(emptySymbols, state.emptySymbol))
+				emptySymbols.push_back(state.emptySymbol);
+		}
+
+		std::vector<std::meta::info> symbols{graph.states.front().emptySymbol};
+		for (std::meta::info alphabet : get_reachable_states_and_symbols<Descriptor>().symbols.data) {
+			for (std::meta::info e : enumerators_of(alphabet)) {
+				auto symbol = constant_of(e);
+				if (!std::ranges::contains(emptySymbols, symbol))
+					symbols.push_back(symbol);
+			}
+		}
+
+		return SymbolNumbering{std::define_static_array(emptySymbols), std::define_static_array(symbols)};
+	}
+
+	template <typename Descriptor>
+	struct SymbolTable {
+		using SymbolVariant = ComputedVariants<Descriptor>::Symbol;
+
+		static constexpr SymbolNumbering numbering = get_symbol_numbering<Descriptor>();
+		static constexpr std::size_t count = numbering.symbols.size();
+
+		using Id = std::conditional_t<(count <= 256), std::uint8_t, std::uint16_t>;
+		static_assert(count <= 65536, "Too many reachable symbols");
+
+		static constexpr Id blank = 0;
+
+		template <auto symbol>
+		static constexpr Id id = numbering.id_of(std::meta::reflect_constant(symbol));
+
+		static consteval Id id_of(std::meta::info symbol) {
+			return numbering.id_of(symbol);
+		}
+
+		static constexpr Id encode(const SymbolVariant& symbol) {
+			return std::visit([]<typename Symbol>(Symbol x) -> Id {
+				template for (constexpr auto e : std::define_static_array(enumerators_of(^^Symbol))) {
+					constexpr Symbol value = [:e:];
+					if (value == x)
+						return id<value>;
+				}
+				std::unreachable();
+			}, symbol);
+		}
+
+		static constexpr SymbolVariant decode(Id symbol) {
+			static constexpr auto table = [] {
+				std::array<SymbolVariant, count> out;
+				std::size_t i = 0;
+				template for (constexpr auto symbol : std::define_static_array(numbering.symbols))
+					out[i++] = [:symbol:];
+				return out;
+			}();
+			return table[symbol];
+		}
+	};
+};
+
+#endif // SYMBOL_TABLE_HPP
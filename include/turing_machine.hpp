@@ -3,228 +3,921 @@
 
 #include "utility.hpp"
 #include "decl_components.hpp"
+#include "chunked_tape.hpp"
+#include "machine_graph.hpp"
+#include "fusion.hpp"
+#include "symbol_table.hpp"
+#include "sweep.hpp"
+#include "execution_stats.hpp"
+#include "profile.hpp"
+#include "replay_log.hpp"
 
 #include <vector>
 #include <ranges>
 #include <meta>
-#include <stdexcept>
 #include <span>
 #include <optional>
-#include <iterator>
 #include <utility>
 #include <print>
 #include <set>
-#include <concepts>
 #include <variant>
 #include <algorithm>
+#include <thread>
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include <chrono>
+#include <limits>
 
-namespace impl {
-	template <typename T>
-	struct LinearSet {
-		std::vector<T> data;
-		
-		constexpr void insert(T x) {
-			if (!std::ranges::contains(data, x))
-				data.push_back(std::move(x));
+template <typename Descriptor>
+class TuringMachine {
+	static_assert(impl::get_tape_count<impl::get_state_enum<Descriptor>()>() == 1, "Use MultiTapeTuringMachine for machines with more than one tape");
+	static_assert(impl::has_uniform_tape_count<Descriptor>(), "All reachable machines must declare the same number of tapes");
+
+	using StateVariant = impl::ComputedVariants<Descriptor>::State;
+	using SymbolVariant = impl::ComputedVariants<Descriptor>::Symbol;
+	// Cells store global symbol IDs rather than SymbolVariants, converted at the API boundary
+	using Symbols = impl::SymbolTable<Descriptor>;
+	using SymbolId = Symbols::Id;
+	using Tape = ChunkedTape<SymbolId>;
+
+	// States are numbered by their position in the reachable graph, the current state is a single integer
+	// which indexes per state handlers, StateVariants are only produced at the API boundary
+	static constexpr impl::MachineGraph graph = impl::machine_graph<Descriptor>;
+	static constexpr std::size_t stateCount = graph.states.size();
+	using StateId = std::conditional_t<(stateCount <= 65536), std::uint16_t, std::uint32_t>;
+	static constexpr StateId startState = graph.index_of(impl::get_start_state<Descriptor>());
+
+	static constexpr std::size_t maxCallDepth = [] {
+		using State = [:impl::get_state_enum<Descriptor>():];
+		using Symbol = [:impl::get_symbol<Descriptor>():];
+		return annotation_of<Config<Symbol>>(dealias(^^State))->maxCallDepth;
+	}();
+
+	Tape tape_;
+	std::size_t head_ = 0;
+	StateId state_ = startState;
+	// Return states pushed by RCall
+	std::array<StateId, maxCallDepth> callStack_;
+	std::size_t callDepth_ = 0;
+	// Transitions performed since reset, including the halting transition
+	std::size_t steps_ = 0;
+	ExecutionStatus status_ = ExecutionStatus::Running;
+	// Contiguous copy of tape_ handed out by execute
+	std::vector<SymbolVariant> output_;
+	// Head extremes and time spent running since reset, see run
+	std::size_t minHead_ = 0;
+	std::size_t maxHead_ = 0;
+	std::chrono::nanoseconds elapsed_{};
+	// Response hit counters, see set_profile
+	std::vector<std::uint64_t>* profile_ = nullptr;
+	// Parallel sweeps, see set_parallel_sweep
+	unsigned sweepThreads_ = 1;
+	std::size_t sweepMinRegion_ = 0;
+
+	[[nodiscard]] static constexpr StateVariant to_state_variant(StateId state) {
+		static constexpr auto table = [] {
+			std::array<StateVariant, stateCount> out;
+			std::size_t i = 0;
+			template for (constexpr impl::ErasedState erased : std::define_static_array(graph.states))
+				out[i++] = [:erased.enumerator:];
+			return out;
+		}();
+		return table[state];
+	}
+
+	// Builds a table of Handler<id> for every state ID
+	template <template <std::size_t> typename Handler>
+	static constexpr auto make_state_table() {
+		return []<std::size_t... ids>(std::index_sequence<ids...>) {
+			return std::array{&Handler<ids>::run...};
+		}(std::make_index_sequence<stateCount>{});
+	}
+
+	// Writes and moves for a single transition, returns false without writing if the head would move left of tape position 0
+	template <impl::ErasedResponse response>
+	static constexpr bool apply(Tape& tape, std::size_t& head) {
+		if constexpr (response.action == Action::Left) {
+			if (head == 0)
+				return false;
 		}
-	};
 
-	struct ReachableStatesAndSymbols {
-		LinearSet<std::meta::info> states;
-		LinearSet<std::meta::info> symbols;
-	};
+		if constexpr (!response.anyWrite) {
+			constexpr SymbolId write = Symbols::id_of(response.write);
+			tape.set(head, write);
+		}
+
+		if constexpr (response.action == Action::Left)
+			--head;
+		else if constexpr (response.action == Action::Right) {
+			if (++head == tape.size())
+				tape.push_back(Symbols::blank);
+		}
+		return true;
+	}
+
+	// The status the transition would fault with from the current configuration, or Running if it can be taken
+	template <impl::ErasedResponse response>
+	[[nodiscard]] constexpr ExecutionStatus check() const {
+		if constexpr (response.action == Action::Left) {
+			if (head_ == 0)
+				return ExecutionStatus::TapeUnderflow;
+		}
+		if constexpr (response.action != Action::Halt && response.link == Link::Call) {
+			if (callDepth_ == maxCallDepth)
+				return ExecutionStatus::CallStackOverflow;
+		}
+		else if constexpr (response.action != Action::Halt && response.link == Link::Return) {
+			if (callDepth_ == 0)
+				return ExecutionStatus::CallStackUnderflow;
+		}
+		return ExecutionStatus::Running;
+	}
 
+	// Assumes check<response>() passed
+	template <impl::ErasedResponse response>
+	constexpr void follow() {
+		if constexpr (response.link == Link::Jump) {
+			constexpr StateId next = graph.index_of(response.next);
+			state_ = next;
+		}
+		else if constexpr (response.link == Link::Call) {
+			constexpr StateId next = graph.index_of(response.next);
+			constexpr StateId returnTo = graph.index_of(response.returnTo);
+			callStack_[callDepth_++] = returnTo;
+			state_ = next;
+		}
+		else
+			state_ = callStack_[--callDepth_];
+	}
+
+	// Stops execution, returns true for the step loop
+	constexpr bool stop(ExecutionStatus status) {
+		status_ = status;
+		return true;
+	}
+
+	// Runs the superinstruction starting at this state and the symbol under the head if there is one, otherwise the first matching Response
+	// Superinstructions are skipped (fuse == false) while tracing or profiling so every transition is seen, recording logs them per transition
+	// Responses are tried in impl::response_order, which follows the response_profile if there is one
+	// States with a matching Response for every symbol ID skip the missing transition fallback entirely
+	template <bool fuse>
+	struct StepState {
+		template <std::size_t id>
+		struct Handler {
+			static constexpr bool run(TuringMachine& tm) {
+				constexpr impl::ErasedState state = graph.states[id];
+				if constexpr (!state.hasResponseList)
+					return tm.stop(ExecutionStatus::MissingTransition);
+				else {
+					const SymbolId symbol = tm.tape_[tm.head_];
+					if constexpr (fuse) {
+						static constexpr auto chains = fused_chains<id>();
+						if constexpr (std::ranges::any_of(chains, [](FusedIndex index) { return index != 0; })) {
+							if (const FusedIndex chain = chains[symbol])
+								return fused_entry(chain)(tm);
+						}
+					}
+
+					template for (constexpr std::size_t index : std::define_static_array(impl::response_order<Descriptor, id>)) {
+						constexpr impl::ErasedResponse response = graph.responses[index];
+						constexpr SymbolId read = response.anyRead ? Symbols::blank : Symbols::id_of(response.read);
+						if (response.anyRead || symbol == read) {
+							if (const ExecutionStatus fault = tm.template check<response>(); fault != ExecutionStatus::Running)
+								return tm.stop(fault);
+
+							if constexpr (!fuse) {
+								if (tm.profile_ != nullptr)
+									++(*tm.profile_)[index];
+							}
+							if (tm.replay_)
+								tm.template record<response, id>(symbol);
+							++tm.steps_;
+							(void)apply<response>(tm.tape_, tm.head_);
+
+							if constexpr (response.action == Action::Halt)
+								return tm.stop(ExecutionStatus::Halted);
+							else {
+								tm.template follow<response>();
+								return false;
+							}
+						}
+					}
 
-	template <std::meta::info e>
-	consteval auto get_enumerator_linked_scopes() -> LinearSet<std::meta::info> {
-		LinearSet<std::meta::info> linkedScopes;
-		template for (constexpr auto a : std::define_static_array(annotations_of(e))) {
-			constexpr auto type = type_of(a);
-			if constexpr (has_template_arguments(type) && template_of(type) == ^^ResponseList) {
-				// Found response list
-				template for (constexpr auto responseInfo : std::define_static_array(template_arguments_of(type) | std::views::drop(1))) {
-					constexpr auto response = [:responseInfo:];
-					linkedScopes.insert(response.nextState.stateEnum);
+					constexpr bool covered = Symbols::numbering.covers(graph, state);
+					if constexpr (covered)
+						std::unreachable();
+					else
+						return tm.stop(ExecutionStatus::MissingTransition);
 				}
 			}
+		};
+	};
+
+	// Chains are numbered from 1 in impl::fused_starts order, 0 is no chain
+	static constexpr std::size_t fusedCount = impl::fused_starts<Descriptor>.size();
+	using FusedIndex = std::conditional_t<(fusedCount < 256), std::uint8_t, std::conditional_t<(fusedCount < 65536), std::uint16_t, std::uint32_t>>;
+	using FusedEntry = bool (*)(TuringMachine&);
+
+	// Number of the chain from each symbol ID in state id, symbols the state can't see have none
+	template <std::size_t id>
+	static consteval std::array<FusedIndex, Symbols::count> fused_chains() {
+		std::array<FusedIndex, Symbols::count> out{};
+		for (std::size_t i = 0; i < fusedCount; ++i) {
+			if (impl::fused_starts<Descriptor>[i].state == id)
+				out[impl::fused_starts<Descriptor>[i].symbol] = static_cast<FusedIndex>(i + 1);
 		}
-		return linkedScopes;
+		return out;
+	}
+
+	// Shared by every state, so each state only stores the small chain numbers
+	static constexpr FusedEntry fused_entry(FusedIndex chain) {
+		static constexpr auto entries = []<std::size_t... i>(std::index_sequence<i...>) {
+			return std::array<FusedEntry, fusedCount + 1>{nullptr, &enter_fused<impl::fused_starts<Descriptor>[i].state, impl::fused_starts<Descriptor>[i].symbol>...};
+		}(std::make_index_sequence<fusedCount>{});
+		return entries[chain];
 	}
 
-	template <typename Descriptor>
-	consteval void get_reachable_states_and_symbols_helper(ReachableStatesAndSymbols& out) {
-		out.symbols.insert(impl::get_symbol<Descriptor>());
-		constexpr auto stateEnum = impl::get_state_enum<Descriptor>();
-		out.states.insert(stateEnum);
-		
-		template for (constexpr auto e : std::define_static_array(enumerators_of(stateEnum))) {
-			template for (constexpr auto scope : std::define_static_array(get_enumerator_linked_scopes<e>().data)) {
-				if (!std::ranges::contains(out.states.data, scope))
-					get_reachable_states_and_symbols_helper<typename [:scope:]>(out);
+	template <std::size_t id, std::size_t symbol>
+	static constexpr bool enter_fused(TuringMachine& tm) {
+		return tm.template run_fused<id, symbol>();
+	}
+
+	template <std::size_t id, std::size_t symbol>
+	constexpr bool run_fused() {
+		constexpr impl::FusedChain chain = impl::fused_chain<Descriptor, id, symbol>;
+
+		// The call stack is only touched by the last step, a chain which would fault there is stepped one transition at a time instead
+		if constexpr (!chain.halts && chain.link == Link::Call) {
+			if (callDepth_ == maxCallDepth)
+				return StepState<false>::template Handler<id>::run(*this);
+		}
+		else if constexpr (!chain.halts && chain.link == Link::Return) {
+			if (callDepth_ == 0)
+				return StepState<false>::template Handler<id>::run(*this);
+		}
+
+		// Keyframes are only taken between superinstructions, so one may be up to maxFusedLength transitions late
+		if (replay_)
+			keyframe_if_due();
+
+		[[maybe_unused]] const std::size_t origin = head_;
+		std::size_t performed = 0;
+		template for (constexpr impl::FusedStep fused : std::define_static_array(chain.steps)) {
+			if constexpr (fused.action == Action::Left) {
+				// Fault in the intermediate state, as if the chain had been stepped one transition at a time
+				if (head_ == 0) {
+					constexpr StateId faultState = graph.index_of(fused.state);
+					steps_ += performed;
+					state_ = faultState;
+					return stop(ExecutionStatus::TapeUnderflow);
+				}
 			}
+
+			// Everything but the overwritten symbol and, for a return, the previous state is known at compile time
+			if (replay_) {
+				constexpr StateId from = graph.index_of(fused.state);
+				typename Replay::Entry entry{fused.action, fused.link, fused.action == Action::Right && head_ + 1 == tape_.size(), std::nullopt, std::nullopt};
+				if constexpr (fused.write != std::meta::info{}) {
+					constexpr SymbolId write = Symbols::id_of(fused.write);
+					if (tape_[head_] != write)
+						entry.overwritten = tape_[head_];
+				}
+				if constexpr (fused.next == std::meta::info{}) {
+					if (callStack_[callDepth_ - 1] != from)
+						entry.previous = from;
+				}
+				else if constexpr (graph.index_of(fused.next) != from)
+					entry.previous = from;
+				replay_->push(entry);
+			}
+
+			if constexpr (fused.write != std::meta::info{}) {
+				constexpr SymbolId write = Symbols::id_of(fused.write);
+				tape_.set(head_, write);
+			}
+
+			if constexpr (fused.action == Action::Left)
+				--head_;
+			else if constexpr (fused.action == Action::Right) {
+				if (++head_ == tape_.size())
+					tape_.push_back(Symbols::blank);
+			}
+			++performed;
 		}
-	}
+		steps_ += chain.steps.size();
 
-	// TODO: Assert that empty symbols match. --actually, maybe just allow dropping empty symbols from non-entry machines, since emtpy symbols can never match with different alphabets
-	template <typename Descriptor>
-	consteval ReachableStatesAndSymbols get_reachable_states_and_symbols() {
-		ReachableStatesAndSymbols out;
-		get_reachable_states_and_symbols_helper<Descriptor>(out);
-		return out;
+		// The execution loop only sees the head between superinstructions, so record any excursion past both ends
+		if constexpr (chain.lowest < std::min<std::ptrdiff_t>(chain.offset, 0))
+			minHead_ = std::min(minHead_, origin - static_cast<std::size_t>(-chain.lowest));
+		if constexpr (chain.highest > std::max<std::ptrdiff_t>(chain.offset, 0))
+			maxHead_ = std::max(maxHead_, origin + static_cast<std::size_t>(chain.highest));
+
+		if constexpr (chain.halts) {
+			constexpr StateId finalState = graph.index_of(chain.finalState);
+			state_ = finalState;
+			return stop(ExecutionStatus::Halted);
+		}
+		else if constexpr (chain.link == Link::Return)
+			state_ = callStack_[--callDepth_];
+		else {
+			if constexpr (chain.link == Link::Call) {
+				constexpr StateId returnTo = graph.index_of(chain.returnTo);
+				callStack_[callDepth_++] = returnTo;
+			}
+			constexpr StateId finalState = graph.index_of(chain.finalState);
+			state_ = finalState;
+		}
+		return false;
 	}
 
-	template <typename Descriptor>
-	struct ComputedVariants {
-		using State = [:substitute(^^std::variant, get_reachable_states_and_symbols<Descriptor>().states.data):];
-		using Symbol = [:substitute(^^std::variant, get_reachable_states_and_symbols<Descriptor>().symbols.data):];
+	// Nondeterministic branches and replay keyframes
+	// Configurations share tape chunks, so forking a branch only copies the chunk it writes to
+	struct Configuration {
+		StateId state;
+		std::size_t head;
+		Tape tape;
+		std::vector<StateId> callStack;
+
+		auto operator<=>(const Configuration&) const = default;
 	};
-};
 
-template <typename Descriptor>
-class TuringMachine {
-	using StateVariant = impl::ComputedVariants<Descriptor>::State;
-	using SymbolVariant = impl::ComputedVariants<Descriptor>::Symbol;
+	// Undo log with Configurations as keyframes, see enable_replay
+	using Replay = ReplayLog<SymbolId, StateId, Configuration>;
+	std::optional<Replay> replay_;
 
-	std::vector<SymbolVariant> tape_;
-	std::ranges::iterator_t<decltype(tape_)> head_;
-	StateVariant state_;
-	SymbolVariant emptySymbol_;
-
-	template <typename Symbol>
-	struct ResponseVariant {
-		Symbol read;
-		Symbol write;
-		Action action;
-		structural::StringView nextStateName;
-		StateVariant nextStateEnum;
-
-		template <auto response>
-		static constexpr ResponseVariant<Symbol> create() {
-			return ResponseVariant<Symbol>{
-				.read = response.read,
-				.write = response.write,
-				.action = response.action,
-				.nextStateName = response.nextState.name,
-				.nextStateEnum = typename [:response.nextState.stateEnum:]{}
-			};
-		}
+	// Keyframes the current configuration if one is due, called before logging the transitions taken from it
+	void keyframe_if_due() {
+		if (replay_->keyframe_due(steps_))
+			replay_->add_keyframe(steps_, Configuration{state_, head_, tape_, {callStack_.begin(), callStack_.begin() + callDepth_}});
+	}
+
+	// Result of sweeping one region of tape from a single entry state
+	struct SweepOutcome {
+		// Sweep state after the last consumed cell
+		std::uint32_t local;
+		std::size_t consumed;
+		// Left the sweep states, or found no matching Response
+		bool stopped;
+		bool exited;
+		// Global state ID jumped to if exited
+		std::uint32_t exitState;
 	};
 
-	template <std::meta::info responseList>
-	[[nodiscard]] static constexpr auto get_response_from_list(auto head, auto anySymbol) {
-		template for (constexpr std::meta::info responseInfo : std::define_static_array(template_arguments_of(responseList) | std::views::drop(1))) {
-			constexpr auto response = [:responseInfo:];
-			bool match = response.read == std::get<typename decltype(response)::Symbol>(*head);
-			if (match || response.read == anySymbol)
-				return ResponseVariant<typename decltype(response)::Symbol>::template create<response>();
-				// return ScopedResponse<typename [:response.nextState.stateEnum:], typename decltype(response)::Symbol>{response};
-		}
-		throw std::runtime_error("Could not find valid Response");
-	}
-
-	template <typename State>
-	[[nodiscard]] static constexpr auto get_response(State state, auto head, auto anySymbol) {
-		template for (constexpr auto e : std::define_static_array(enumerators_of(^^State))) {
-			if (state == [:e:]) {
-				template for (constexpr auto a : std::define_static_array(annotations_of(e))) {
-					constexpr std::meta::info type = type_of(a);
-					if constexpr (has_template_arguments(type) && template_of(type) == ^^ResponseList)
-						return get_response_from_list<type>(head, anySymbol);
+	// Sweeps cells [first, last), chunks holds the data of every chunk from chunkBase onwards
+	// Only writes if Cell is non const, so the same code summarises regions and replays them
+	// While recording, written parts log every transition into log (tapeSize is the size of the tape the sweep started on)
+	template <typename Cell>
+	static SweepOutcome sweep_part(std::span<Cell* const> chunks, std::size_t chunkBase, std::size_t first, std::size_t last, std::uint32_t local, Replay* log = nullptr, std::size_t tapeSize = 0) {
+		constexpr impl::SweepTable table = impl::sweep_table<Descriptor>;
+		constexpr std::size_t chunkSize = Tape::chunk_size;
+
+		SweepOutcome out{local, 0, false, false, 0};
+		for (std::size_t i = first; i < last; ++i) {
+			Cell& cell = chunks[i / chunkSize - chunkBase][i % chunkSize];
+			const impl::SweepTransition& transition = table.transitions[out.local * table.symbols + cell];
+			if (!transition.defined) {
+				out.stopped = true;
+				break;
+			}
+			if constexpr (!std::is_const_v<Cell>) {
+				if (log != nullptr) {
+					const std::uint32_t next = transition.exits ? transition.next : table.global[transition.next];
+					typename Replay::Entry entry{Action::Right, Link::Jump, i + 1 == tapeSize, std::nullopt, std::nullopt};
+					if (transition.writes && cell != transition.write)
+						entry.overwritten = cell;
+					if (next != table.global[out.local])
+						entry.previous = static_cast<StateId>(table.global[out.local]);
+					log->push(entry);
 				}
+				if (transition.writes)
+					cell = static_cast<SymbolId>(transition.write);
+			}
+			++out.consumed;
+			if (transition.exits) {
+				out.stopped = out.exited = true;
+				out.exitState = transition.next;
+				break;
+			}
+			out.local = transition.next;
+		}
+		return out;
+	}
+
+	// Pointers to the data of every chunk overlapping cells [first, last), unsharing them so they can be written
+	std::vector<SymbolId*> writable_chunks(std::size_t first, std::size_t last) {
+		constexpr std::size_t chunkSize = Tape::chunk_size;
+		std::vector<SymbolId*> chunks((last - 1) / chunkSize - first / chunkSize + 1);
+		for (std::size_t chunk = 0; chunk < chunks.size(); ++chunk)
+			chunks[chunk] = tape_.mutable_chunk(first / chunkSize + chunk).data();
+		return chunks;
+	}
+
+	// Sweeps cells [begin, end) from the sweep state `entry` (see impl::SweepTable) split between sweepThreads_ workers
+	// 1. Every part but the first is summarised from every possible entry state in parallel, without writing
+	// 2. The summaries are chained from the real entry state to find the state each part is actually entered in
+	// 3. Each part is replayed from that state in parallel, writing the tape
+	// Parts are chunk aligned so no two workers touch the same chunk
+	// Returns the outcome of the region as a whole, nothing is written if no cell was consumed
+	SweepOutcome sweep_region(std::size_t begin, std::size_t end, std::uint32_t entry) {
+		constexpr impl::SweepTable table = impl::sweep_table<Descriptor>;
+		constexpr std::size_t chunkSize = Tape::chunk_size;
+
+		const std::size_t chunkBase = begin / chunkSize;
+		const std::size_t chunks = (end + chunkSize - 1) / chunkSize - chunkBase;
+		const std::size_t parts = std::min<std::size_t>(sweepThreads_, chunks);
+
+		std::vector<std::size_t> bounds(parts + 1);
+		bounds.front() = begin;
+		bounds.back() = end;
+		for (std::size_t part = 1; part < parts; ++part)
+			bounds[part] = (chunkBase + chunks * part / parts) * chunkSize;
+
+		std::vector<const SymbolId*> readChunks(chunks);
+		for (std::size_t chunk = 0; chunk < chunks; ++chunk)
+			readChunks[chunk] = tape_.chunk(chunkBase + chunk).data();
+
+		std::vector<std::vector<SweepOutcome>> summaries(parts);
+		{
+			std::vector<std::jthread> pool;
+			for (std::size_t part = 1; part < parts; ++part) {
+				pool.emplace_back([&, part] {
+					for (std::uint32_t local = 0; local < table.global.size(); ++local)
+						summaries[part].push_back(sweep_part<const SymbolId>(readChunks, chunkBase, bounds[part], bounds[part + 1], local));
+				});
+			}
+			summaries[0].push_back(sweep_part<const SymbolId>(readChunks, chunkBase, bounds[0], bounds[1], entry));
+		}
+
+		std::vector<std::uint32_t> entries;
+		for (std::uint32_t local = entry; entries.size() < parts;) {
+			const std::size_t part = entries.size();
+			entries.push_back(local);
+			const SweepOutcome& summary = summaries[part][part == 0 ? 0 : local];
+			if (summary.stopped)
+				break;
+			local = summary.local;
+		}
+		const std::size_t used = entries.size();
+		if (summaries[0][0].consumed == 0)
+			return summaries[0][0];
+
+		// Chunks must be unshared before the workers write to them
+		const std::vector<SymbolId*> writeChunks = writable_chunks(begin, bounds[used]);
+
+		// While recording, each part logs into its own undo log and the logs are appended in tape order
+		std::vector<Replay> logs(replay_ ? used : 0, Replay{1});
+		auto log = [&](std::size_t part) { return replay_ ? &logs[part] : nullptr; };
+
+		std::vector<SweepOutcome> outcomes(used);
+		{
+			std::vector<std::jthread> pool;
+			for (std::size_t part = 1; part < used; ++part) {
+				pool.emplace_back([&, part] {
+					outcomes[part] = sweep_part<SymbolId>(writeChunks, chunkBase, bounds[part], bounds[part + 1], entries[part], log(part), tape_.size());
+				});
 			}
+			outcomes[0] = sweep_part<SymbolId>(writeChunks, chunkBase, bounds[0], bounds[1], entries[0], log(0), tape_.size());
+		}
+		for (const Replay& part : logs)
+			replay_->append(part);
+
+		SweepOutcome out = outcomes.back();
+		out.consumed += bounds[used - 1] - begin;
+		return out;
+	}
+
+	// Runs the sweep state `entry` over the rest of the tape, returns false if no cell was consumed (no matching Response)
+	// The first sweepMinRegion_ / 16 cells are swept sequentially, so a sweep which is left early costs no more than stepping it
+	// Each parallel region after that is as long as everything consumed so far, so the summaries wasted past the point the
+	// machine leaves the sweep are bounded by the work already done rather than by the rest of the tape
+	bool run_sweep(std::uint32_t entry) {
+		constexpr impl::SweepTable table = impl::sweep_table<Descriptor>;
+
+		// A sweep is recorded like any other run of transitions, but is only keyframed before it starts
+		if (replay_)
+			keyframe_if_due();
+
+		const std::size_t begin = head_;
+		const std::size_t end = tape_.size();
+		const std::size_t prefix = std::min(end, begin + std::max<std::size_t>(sweepMinRegion_ / 16, 1));
+		SweepOutcome outcome = sweep_part<SymbolId>(writable_chunks(begin, prefix), begin / Tape::chunk_size, begin, prefix, entry, replay_ ? &*replay_ : nullptr, end);
+		std::size_t consumed = outcome.consumed;
+		if (consumed == 0)
+			return false;
+
+		while (!outcome.stopped && begin + consumed < end) {
+			const std::size_t first = begin + consumed;
+			outcome = sweep_region(first, std::min(end, first + consumed), outcome.local);
+			consumed += outcome.consumed;
 		}
-		throw std::runtime_error("Could not find ResponseList");
-	}
-
-	[[nodiscard]] constexpr std::span<SymbolVariant> execute_impl(bool printStates = false) {
-		bool end = false;
-		while (!end) {
-			end = std::visit([this, printStates]<typename State>(State state) -> bool {
-				using Symbol = [:impl::get_symbol<State>():];
-				// Compute anySymbol (TODO: split this out into a function; duplicating reset)
-				constexpr auto annotation = annotation_of<Config<Symbol>>(^^State);
-				if constexpr (!annotation.has_value())
-					throw std::runtime_error("Expected Config");
-				auto anySymbol = annotation->anySymbol;
-				
-				auto response = get_response(state, head_, anySymbol);
-				
-				if (response.write != anySymbol)
-					*head_ = response.write;
-
-				switch (response.action) {
-				case Action::Left:
-					if (head_ == tape_.begin())
-						throw std::runtime_error("Execution tried to move left of tape position 0");
-					head_ = std::prev(head_);
-					break;
-				case Action::Right:
-					head_ = std::next(head_);
-					if (head_ == tape_.end()) {
-						tape_.push_back(emptySymbol_);
-						head_ = std::prev(tape_.end());
+
+		steps_ += consumed;
+		head_ += consumed;
+		if (head_ == tape_.size())
+			tape_.push_back(Symbols::blank);
+		state_ = static_cast<StateId>(outcome.exited ? outcome.exitState : table.global[outcome.local]);
+		return true;
+	}
+
+	// Nondeterministic execution: every matching Response forks the configuration (see Configuration)
+	// Pushes every successor of config to out, returns the halted configuration if any branch halts
+	// Branches without a matching Response, which move left of tape position 0, or which overflow/underflow the call stack are rejected
+	template <std::size_t id>
+	struct ExpandState {
+		static std::optional<Configuration> run(const Configuration& config, std::vector<Configuration>& out) {
+			constexpr impl::ErasedState state = graph.states[id];
+			if constexpr (state.hasResponseList) {
+				const SymbolId symbol = config.tape[config.head];
+				template for (constexpr impl::ErasedResponse response : std::define_static_array(graph.responses_of(state))) {
+					constexpr SymbolId read = response.anyRead ? Symbols::blank : Symbols::id_of(response.read);
+					if (response.anyRead || symbol == read) {
+						Configuration next = config;
+						if (apply<response>(next.tape, next.head)) {
+							if constexpr (response.action == Action::Halt)
+								return next;
+							else if constexpr (response.link == Link::Jump) {
+								next.state = graph.index_of(response.next);
+								out.push_back(std::move(next));
+							}
+							else if constexpr (response.link == Link::Call) {
+								if (next.callStack.size() < maxCallDepth) {
+									next.callStack.push_back(graph.index_of(response.returnTo));
+									next.state = graph.index_of(response.next);
+									out.push_back(std::move(next));
+								}
+							}
+							else {
+								if (!next.callStack.empty()) {
+									next.state = next.callStack.back();
+									next.callStack.pop_back();
+									out.push_back(std::move(next));
+								}
+							}
+						}
 					}
-				case Action::None:
-					break;
-				case Action::Halt:
-					return true;
-				default:
-					std::unreachable();
 				}
-				
-				std::visit([this, &response]<typename Enum>(Enum e){
-					state_ = name_to_enum<Enum>(response.nextStateName).value();
-				}, response.nextStateEnum);
-
-				if (printStates)
-					std::visit([](auto state) { std::println("{}::{}", get_scope_string(state), enum_to_string(state)); }, state_);
-					
-				return false;
-			}, state_);
+			}
+			return std::nullopt;
 		}
-		return tape_;
+	};
+
+	[[nodiscard]] static std::optional<Configuration> expand(const Configuration& config, std::vector<Configuration>& out) {
+		static constexpr auto handlers = make_state_table<ExpandState>();
+		return handlers[config.state](config, out);
+	}
+
+	// Logs the transition about to be taken by the state `id` reading symbol, keyframing first if one is due
+	template <impl::ErasedResponse response, std::size_t id>
+	void record(SymbolId symbol) {
+		keyframe_if_due();
+
+		typename Replay::Entry entry{response.action, response.link, response.action == Action::Right && head_ + 1 == tape_.size(), std::nullopt, std::nullopt};
+		if constexpr (!response.anyWrite) {
+			constexpr SymbolId write = Symbols::id_of(response.write);
+			if (symbol != write)
+				entry.overwritten = symbol;
+		}
+		if constexpr (response.action != Action::Halt) {
+			if constexpr (response.link == Link::Return) {
+				if (callStack_[callDepth_ - 1] != id)
+					entry.previous = static_cast<StateId>(id);
+			}
+			else if constexpr (graph.index_of(response.next) != id)
+				entry.previous = static_cast<StateId>(id);
+		}
+		replay_->push(entry);
+	}
+
+	void restore(const typename Replay::Keyframe& keyframe) {
+		const Configuration& config = keyframe.snapshot;
+		state_ = config.state;
+		head_ = config.head;
+		tape_ = config.tape;
+		std::ranges::copy(config.callStack, callStack_.begin());
+		callDepth_ = config.callStack.size();
+		steps_ = keyframe.step;
+		status_ = ExecutionStatus::Running;
+	}
+
+	[[nodiscard]] constexpr ExecutionResult<SymbolVariant, StateVariant> execute_impl(bool printStates = false) {
+		while (!run(std::numeric_limits<std::size_t>::max(), printStates));
+		return result();
 	}
 
 public:
 	constexpr void reset() {
-		using State = [:impl::get_state_enum<Descriptor>():];
-		using Symbol = [:impl::get_symbol<Descriptor>():];
+		state_ = startState;
+		head_ = 0;
+		callDepth_ = 0;
+		steps_ = 0;
+		status_ = ExecutionStatus::Running;
+		minHead_ = maxHead_ = 0;
+		elapsed_ = {};
+		if (replay_)
+			replay_->clear();
+	}
 
-		// TODO: Split this out
-		constexpr auto annotation = annotation_of<Config<Symbol>>(dealias(^^State));
-		if constexpr (!annotation.has_value())
-			throw std::runtime_error("Expected Config");
-		state_ = name_to_enum<State>(annotation->startStateName).value();
+	constexpr TuringMachine() = default;
 
-		head_ = tape_.begin();
+	// Loads input and resets to the start state without executing, for driving the machine with step()
+	constexpr void load(std::vector<SymbolVariant> input) {
+		tape_.clear();
+		for (const SymbolVariant& symbol : input)
+			tape_.push_back(Symbols::encode(symbol));
+		if (tape_.size() == 0)
+			tape_.push_back(Symbols::blank);
+		reset();
 	}
 
-	constexpr TuringMachine() {
-		// TODO: Split this out
-		using State = [:impl::get_state_enum<Descriptor>():];
-		using Symbol = [:impl::get_symbol<Descriptor>():];
+	// Performs a single transition, returns true once the machine has stopped (halted or faulted, see status())
+	// Unless printStates is set or profiling, compile time decidable chains of transitions are performed at once (see steps())
+	constexpr bool step(bool printStates = false) {
+		static constexpr auto fused = make_state_table<StepState<true>::template Handler>();
+		static constexpr auto unfused = make_state_table<StepState<false>::template Handler>();
+
+		if (!printStates && profile_ == nullptr) {
+			if (sweepThreads_ > 1) {
+				constexpr impl::SweepTable sweep = impl::sweep_table<Descriptor>;
+				const std::int32_t local = sweep.local[state_];
+				if (local >= 0 && tape_.size() - head_ >= sweepMinRegion_ && run_sweep(static_cast<std::uint32_t>(local)))
+					return false;
+			}
+			return fused[state_](*this);
+		}
+
+		bool stopped = unfused[state_](*this);
+		if (printStates && !stopped)
+			std::visit([](auto state) { std::println("{}::{}", get_scope_string(state), enum_to_string(state)); }, state());
+		return stopped;
+	}
+
+	// Counts how often each Response is taken into hits (indexed like impl::MachineGraph::responses), nullptr stops profiling
+	// Profiling disables superinstructions and parallel sweeps, pass the counts to write_profile to build a response_profile
+	constexpr void set_profile(std::vector<std::uint64_t>* hits) {
+		if (hits != nullptr)
+			hits->resize(graph.responses.size());
+		profile_ = hits;
+	}
 
-		constexpr auto annotation = annotation_of<Config<Symbol>>(dealias(^^State));
-		if constexpr (!annotation.has_value())
-			throw std::runtime_error("Expected Config");
-		emptySymbol_ = annotation->emptySymbol;
+	// Splits long rightward sweeps over the tape between up to `threads` workers (1 disables, the default)
+	// A sweep is a run of states whose every Response moves right and jumps, entered with at least minRegion cells to the right of the head
+	// It only goes parallel after a sequential prefix of minRegion / 16 cells, see run_sweep
+	// The result is identical to sequential execution, sweeps are skipped while tracing
+	constexpr void set_parallel_sweep(unsigned threads, std::size_t minRegion = std::size_t{1} << 20) {
+		sweepThreads_ = std::max(threads, 1u);
+		sweepMinRegion_ = std::max<std::size_t>(minRegion, 1);
+	}
+
+	// Records every transition from now on into an undo log, so execution can be stepped backwards or seeked to any recorded step
+	// Entries are a byte for transitions which neither change their cell nor their state, plus the overwritten symbol and previous state ID
+	// when they do; a keyframe (the configuration, sharing tape chunks) is kept every keyframeInterval transitions to bound seeking
+	// Superinstructions and parallel sweeps log each of their transitions, but are only keyframed before they start; reset() and load() clear the log
+	void enable_replay(std::size_t keyframeInterval = std::size_t{1} << 16) {
+		replay_.emplace(keyframeInterval);
+	}
+
+	void disable_replay() {
+		replay_.reset();
+	}
+
+	// The undo log, nullptr unless recording
+	[[nodiscard]] const Replay* replay_log() const noexcept {
+		return replay_ ? &*replay_ : nullptr;
+	}
+
+	// Undoes the last recorded transition (including a halting one, so a halted machine can be stepped back)
+	// Returns false if nothing has been recorded since recording started or the machine was reset
+	// Steps, status and tape size are rewound, the head range and duration in result() are not (see there)
+	bool step_back() {
+		if (!replay_ || replay_->empty())
+			return false;
+
+		const typename Replay::Entry entry = replay_->pop();
+		status_ = ExecutionStatus::Running;
+		--steps_;
+		if (entry.action != Action::Halt) {
+			if (entry.link == Link::Call)
+				--callDepth_;
+			else if (entry.link == Link::Return)
+				callStack_[callDepth_++] = state_;
+		}
+		if (entry.previous)
+			state_ = *entry.previous;
+
+		if (entry.action == Action::Left)
+			++head_;
+		else if (entry.action == Action::Right) {
+			if (entry.grew)
+				tape_.resize(head_, Symbols::blank);
+			--head_;
+		}
+		if (entry.overwritten)
+			tape_.set(head_, *entry.overwritten);
+		return true;
+	}
+
+	// Moves to the configuration after `target` transitions (see steps()), stepping back or restoring the nearest earlier keyframe
+	// and replaying from it, whichever is fewer transitions, or running forward
+	// Returns false if target precedes the recording, or the machine stops before reaching it
+	// Like step_back, seeking leaves the head range and duration in result() as they were
+	bool seek(std::size_t target) {
+		if (!replay_)
+			return false;
+
+		if (target < steps_) {
+			const typename Replay::Keyframe* keyframe = replay_->keyframe_before(target);
+			if (keyframe == nullptr)
+				return false;
+			if (steps_ - target > target - keyframe->step) {
+				restore(*keyframe);
+				replay_->rewind(*keyframe);
+			}
+			while (steps_ > target)
+				step_back();
+		}
+		while (steps_ < target && status_ == ExecutionStatus::Running)
+			step();
+		// A superinstruction or sweep may run past target, but logs each of its transitions so the overshoot can be undone
+		while (steps_ > target)
+			step_back();
+		return steps_ == target;
+	}
+
+	// Runs until the machine stops or at least quantum more transitions have been performed, returns true once stopped
+	// Superinstructions and sweeps are never split, so a quantum may be overrun by them
+	// A quantum of 0 is treated as 1, so every call makes progress
+	constexpr bool run(std::size_t quantum, bool printStates = false) {
+		quantum = std::max<std::size_t>(quantum, 1);
+		const auto begin = std::chrono::steady_clock::now();
+		const std::size_t until = steps_ + std::min(quantum, std::numeric_limits<std::size_t>::max() - steps_);
+
+		// Counters are kept in locals during the run and only written out when it returns
+		std::size_t minHead = head_;
+		std::size_t maxHead = head_;
+		bool stopped = status_ != ExecutionStatus::Running;
+		while (!stopped && steps_ < until) {
+			stopped = step(printStates);
+			minHead = std::min(minHead, head_);
+			maxHead = std::max(maxHead, head_);
+		}
+
+		minHead_ = std::min(minHead, minHead_);
+		maxHead_ = std::max(maxHead, maxHead_);
+		elapsed_ += std::chrono::steady_clock::now() - begin;
+		return stopped;
+	}
+
+	// The tape, statistics and status so far, the tape is a copy valid until the next call
+	// Steps and tape size describe the current configuration, but the head range and duration cover everything run since reset(),
+	// including transitions since undone by step_back or seek
+	[[nodiscard]] constexpr ExecutionResult<SymbolVariant, StateVariant> result() {
+		ExecutionStats stats{
+			.steps = steps_,
+			.minHead = minHead_,
+			.maxHead = maxHead_,
+			// The tape never shrinks during a run, only step_back undoes its growth
+			.tapeHighWater = tape_.size(),
+			.tapeBytes = tape_.chunks() * Tape::chunk_size * sizeof(SymbolId),
+			.duration = elapsed_
+		};
+
+		tape_.copy_to(output_, Symbols::decode);
+		return ExecutionResult<SymbolVariant, StateVariant>{output_, stats, status_, state(), output_[head_]};
+	}
+
+	// Copies the machine mid-execution, the copy shares tape chunks with this machine until either writes to them
+	// O(number of tape chunks), so cheap enough for checkpoints and speculative execution on very large tapes
+	// Only the configuration, counters and sweep settings are copied: the fork has no result() output until it is asked for one,
+	// and neither profiles nor records (so forks can run on other threads without sharing hit counters or copying the undo log)
+	[[nodiscard]] TuringMachine fork() const {
+		TuringMachine out;
+		out.tape_ = tape_;
+		out.head_ = head_;
+		out.state_ = state_;
+		std::ranges::copy(std::span(callStack_).first(callDepth_), out.callStack_.begin());
+		out.callDepth_ = callDepth_;
+		out.steps_ = steps_;
+		out.status_ = status_;
+		out.minHead_ = minHead_;
+		out.maxHead_ = maxHead_;
+		out.elapsed_ = elapsed_;
+		out.sweepThreads_ = sweepThreads_;
+		out.sweepMinRegion_ = sweepMinRegion_;
+		return out;
+	}
+
+	// Cells hold global symbol IDs, see decode()
+	[[nodiscard]] constexpr const Tape& tape() const noexcept {
+		return tape_;
+	}
+
+	[[nodiscard]] static constexpr SymbolVariant decode(SymbolId symbol) {
+		return Symbols::decode(symbol);
+	}
+
+	[[nodiscard]] constexpr std::size_t head() const noexcept {
+		return head_;
+	}
+
+	[[nodiscard]] constexpr StateVariant state() const noexcept {
+		return to_state_variant(state_);
+	}
+
+	[[nodiscard]] constexpr std::size_t steps() const noexcept {
+		return steps_;
+	}
+
+	[[nodiscard]] constexpr ExecutionStatus status() const noexcept {
+		return status_;
 	}
 
 	// TODO: Print first state if printStates == true
-	// TODO: Output nicer error messages which unwrapping a non-matching state string
-	[[nodiscard]] constexpr std::span<SymbolVariant> execute(std::vector<SymbolVariant> input, bool printStates = false) {
-		tape_ = std::move(input);
-		reset();
+	[[nodiscard]] constexpr ExecutionResult<SymbolVariant, StateVariant> execute(std::vector<SymbolVariant> input, bool printStates = false) {
+		load(std::move(input));
 
 		return execute_impl(printStates);
 	}
 
-	[[nodiscard]] constexpr std::span<SymbolVariant> execute(bool printStates = false) {
-		tape_.clear();
-		tape_.resize(1, emptySymbol_);
-		reset();
+	[[nodiscard]] constexpr ExecutionResult<SymbolVariant, StateVariant> execute(bool printStates = false) {
+		return execute({}, printStates);
+	}
 
-		return execute_impl(printStates);
+	// Explores every matching Response breadth first, returning the first halting branch, or the loaded input with status Rejected if every branch is rejected
+	// Configurations are deduplicated so machines which revisit a configuration on every branch still terminate
+	// Each breadth first level is expanded across up to `threads` workers, the halting branch chosen is independent of the thread count
+	// stats.steps is the length of the halting branch (or of the longest rejected one), the head range and tape peak cover every explored configuration
+	[[nodiscard]] ExecutionResult<SymbolVariant, StateVariant> execute_nondeterministic(std::vector<SymbolVariant> input, unsigned threads = 1) {
+		const auto begin = std::chrono::steady_clock::now();
+		load(std::move(input));
+
+		std::set<Configuration> visited;
+		std::vector<const Configuration*> frontier{&*visited.insert({state_, head_, tape_, {}}).first};
+
+		std::size_t tapeHighWater = tape_.size();
+		std::size_t tapeChunks = tape_.chunks();
+		auto explored = [&](const Configuration& config) {
+			minHead_ = std::min(minHead_, config.head);
+			maxHead_ = std::max(maxHead_, config.head);
+			tapeHighWater = std::max(tapeHighWater, config.tape.size());
+			tapeChunks = std::max(tapeChunks, config.tape.chunks());
+		};
+		auto finish = [&](ExecutionStatus status) {
+			status_ = status;
+			elapsed_ = std::chrono::steady_clock::now() - begin;
+			ExecutionResult<SymbolVariant, StateVariant> out = result();
+			out.stats.tapeHighWater = tapeHighWater;
+			out.stats.tapeBytes = tapeChunks * Tape::chunk_size * sizeof(SymbolId);
+			return out;
+		};
+
+		threads = std::max(threads, 1u);
+		while (!frontier.empty()) {
+			// Small levels aren't worth the thread overhead
+			const std::size_t workers = std::min<std::size_t>(threads, (frontier.size() + 63) / 64);
+			const std::size_t slice = (frontier.size() + workers - 1) / workers;
+
+			std::vector<std::vector<Configuration>> successors(workers);
+			std::vector<std::optional<Configuration>> halted(workers);
+			auto work = [&](std::size_t worker) {
+				auto configs = frontier | std::views::drop(worker * slice) | std::views::take(slice);
+				for (const Configuration* config : configs) {
+					halted[worker] = expand(*config, successors[worker]);
+					if (halted[worker])
+						return;
+				}
+			};
+
+			{
+				std::vector<std::jthread> pool;
+				for (std::size_t worker = 1; worker < workers; ++worker)
+					pool.emplace_back(work, worker);
+				work(0);
+			}
+
+			frontier.clear();
+			for (std::size_t worker = 0; worker < workers; ++worker) {
+				if (halted[worker]) {
+					explored(*halted[worker]);
+					state_ = halted[worker]->state;
+					tape_ = std::move(halted[worker]->tape);
+					head_ = halted[worker]->head;
+					++steps_;
+					return finish(ExecutionStatus::Halted);
+				}
+				for (Configuration& config : successors[worker]) {
+					auto [it, inserted] = visited.insert(std::move(config));
+					if (inserted) {
+						explored(*it);
+						frontier.push_back(&*it);
+					}
+				}
+			}
+			// Every configuration in the frontier is one transition further from the input
+			if (!frontier.empty())
+				++steps_;
+		}
+		return finish(ExecutionStatus::Rejected);
 	}
 };
 
@@ -0,0 +1,41 @@
+#ifndef COUNTER_HPP
+#define COUNTER_HPP
+
+#include "decl_components.hpp"
+
+#include <vector>
+#include <variant>
+#include <cstddef>
+
+enum class Symbol {
+	E,
+	_,
+	_0,
+	_1,
+	X
+};
+
+using enum Symbol;
+using enum Action;
+
+// Counts up in binary until the counter overflows into the X marker
+enum class [[=Config<Symbol>{"ToEnd", E, _}]] Counter {
+	ToEnd [[=RL<Counter,
+		{E, _, Left, "Increment"},
+		{_, _, Right, "ToEnd"}
+	>]],
+	Increment [[=RL<Counter,
+		{_1, _0, Left, "Increment"},
+		{_0, _1, Right, "ToEnd"},
+		{X, _, Halt, "Increment"}
+	>]]
+};
+
+// Input for a counter of `bits` bits, all clear
+inline std::vector<std::variant<Symbol>> counter_input(std::size_t bits) {
+	std::vector<std::variant<Symbol>> input{X};
+	input.resize(bits + 1, _0);
+	return input;
+}
+
+#endif // COUNTER_HPP
@@ -0,0 +1,10 @@
+// Response profile for Flipper, generated by write_profile
+#include "profile.hpp"
+
+template <>
+inline constexpr std::span<const std::uint64_t> response_profile<Flipper> = std::define_static_array(std::array<std::uint64_t, 3>{
+	/* Flipper::Scan */ 2, 6, 1,
+});
+
+template <>
+inline constexpr std::uint64_t response_profile_signature<Flipper> = 0xc730b1a533e69b22;
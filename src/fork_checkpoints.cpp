@@ -0,0 +1,65 @@
+#include "decl_components.hpp"
+#include "turing_machine.hpp"
+#include "counter.hpp"
+
+#include <vector>
+#include <ranges>
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+constexpr std::size_t width = 12;
+constexpr std::size_t checkpointSteps = 10000;
+constexpr std::size_t forkThreads = 4;
+
+int main() {
+	const std::vector<std::variant<Symbol>> input = counter_input(width);
+
+	TuringMachine<Counter> tm{};
+	tm.load(input);
+	tm.run(checkpointSteps);
+
+	// Checkpoint the running machine, then run the fork to completion on its own
+	TuringMachine<Counter> ahead = tm.fork();
+	const std::size_t steps = tm.steps();
+	const std::size_t head = tm.head();
+	auto checkpoint = tm.result();
+	const std::vector<std::variant<Symbol>> checkpointTape(checkpoint.begin(), checkpoint.end());
+
+	while (!ahead.run(std::numeric_limits<std::size_t>::max()));
+	auto forked = ahead.result();
+	std::println("fork: {} after {} steps", forked | std::views::transform(state_variant_to_string), forked.stats.steps);
+
+	// The fork only unshares the chunks it writes to, the original is still at the checkpoint
+	auto original = tm.result();
+	if (tm.steps() != steps || tm.head() != head || !std::ranges::equal(original, checkpointTape)) {
+		std::println("running the fork modified the original machine");
+		return 1;
+	}
+
+	// Forks share every chunk, running them and the original on separate threads has each unshare the chunks it writes concurrently,
+	// and the last machine still holding a chunk writes to it in place while the others may just have copied it
+	std::vector<TuringMachine<Counter>> forks;
+	for (std::size_t i = 0; i < forkThreads; ++i)
+		forks.push_back(tm.fork());
+	{
+		std::vector<std::jthread> pool;
+		for (auto& fork : forks)
+			pool.emplace_back([&fork] { while (!fork.run(std::numeric_limits<std::size_t>::max())); });
+		while (!tm.run(std::numeric_limits<std::size_t>::max()));
+	}
+	for (auto& fork : forks) {
+		auto concurrent = fork.result();
+		if (concurrent.status != forked.status || concurrent.stats.steps != forked.stats.steps || !std::ranges::equal(concurrent, forked)) {
+			std::println("a fork run on its own thread finished differently");
+			return 1;
+		}
+	}
+
+	auto finished = tm.result();
+	std::println("original: {} after {} steps", finished | std::views::transform(state_variant_to_string), finished.stats.steps);
+	if (finished.status != forked.status || finished.stats.steps != forked.stats.steps || !std::ranges::equal(finished, forked)) {
+		std::println("fork and original finished differently");
+		return 1;
+	}
+}
@@ -0,0 +1,65 @@
+#ifndef INVERTER_HPP
+#define INVERTER_HPP
+
+#include "decl_components.hpp"
+
+#include <vector>
+#include <variant>
+#include <cstddef>
+
+enum class Symbol {
+	E,
+	_,
+	S,
+	C,
+	X,
+	D,
+	_0,
+	_1
+};
+
+using enum Symbol;
+using enum Action;
+
+// Inverts every bit of S C...C X bits once, then once more per C, sweeping right over the bits and rewinding after each pass
+// ToBits and Invert only move right and jump, so they are sweep states
+// Decrement reading C and Invert reading the blank past the bits start chains of transitions which are fused into superinstructions
+enum class [[=Config<Symbol>{"ToBits", E, _}]] Inverter {
+	ToBits [[=RL<Inverter,
+		{X, _, Right, "Invert"},
+		{_, _, Right, "ToBits"}
+	>]],
+	Invert [[=RL<Inverter,
+		{_0, _1, Right, "Invert"},
+		{_1, _0, Right, "Invert"},
+		{D, _, Right, "Invert"},
+		{_, _, Right, "Back"}
+	>]],
+	Back [[=RL<Inverter,
+		{_, _, Left, "Rewind"}
+	>]],
+	Rewind [[=RL<Inverter,
+		{X, _, Left, "Decrement"},
+		{_, _, Left, "Rewind"}
+	>]],
+	// Moves the X marker left over the next C, halting once the counter is used up
+	Decrement [[=RL<Inverter,
+		{C, X, Right, "Clear"},
+		{S, _, Halt, "Decrement"}
+	>]],
+	Clear [[=RL<Inverter,
+		{_, D, Right, "Invert"}
+	>]]
+};
+
+// Input for `passes` passes over `bits` bits, every third of which is set
+inline std::vector<std::variant<Symbol>> inverter_input(std::size_t passes, std::size_t bits) {
+	std::vector<std::variant<Symbol>> input{S};
+	input.resize(passes, C);
+	input.push_back(X);
+	for (std::size_t i = 0; i < bits; ++i)
+		input.push_back(i % 3 == 0 ? _1 : _0);
+	return input;
+}
+
+#endif // INVERTER_HPP
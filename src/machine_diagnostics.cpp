@@ -0,0 +1,67 @@
+#include "decl_components.hpp"
+#include "diagnostics.hpp"
+
+#include <print>
+#include <meta>
+#include <string_view>
+#include <algorithm>
+
+enum class Symbol {
+	_,
+	E,
+	_0,
+	_1
+};
+
+using enum Symbol;
+using enum Action;
+
+// Deliberately broken, every diagnostic should find something
+enum class [[=Config<Symbol>{"Start", E, _}]] Broken {
+	Start [[=RL<Broken,
+		{_0, _0, Right, "Start"},
+		// Never taken, the Response above already reads _0
+		{_0, _1, Right, "Start"},
+		{_1, _1, None, "Flip"},
+		// Halting never enters the named state, so this does not make Halted reachable
+		{E, _, Halt, "Halted"}
+	>]],
+	// Flips the cell forever without moving, and has no Response reading E
+	Flip [[=RL<Broken,
+		{_1, _0, None, "Flip"},
+		{_0, _1, None, "Flip"}
+	>]],
+	Halted [[=RL<Broken,
+		{_, _, Halt, "Halted"}
+	>]],
+	Orphan [[=RL<Broken,
+		{_, _, Halt, "Orphan"}
+	>]]
+};
+
+constexpr MachineDiagnostics diagnostics = machine_diagnostics<Broken>;
+
+static_assert(diagnostics.unreachable.size() == 2);
+static_assert(std::ranges::contains(diagnostics.unreachable, ^^Broken::Halted));
+static_assert(std::ranges::contains(diagnostics.unreachable, ^^Broken::Orphan));
+
+static_assert(diagnostics.missing.size() == 1);
+static_assert(diagnostics.missing[0].state == ^^Broken::Flip);
+static_assert(diagnostics.missing[0].symbol == std::meta::reflect_constant(E));
+
+static_assert(diagnostics.shadowed.size() == 1);
+static_assert(diagnostics.shadowed[0].state == ^^Broken::Start);
+static_assert(diagnostics.shadowed[0].index == 1);
+
+// Start reading _1 enters the loop at (Flip, _1), which comes back to itself after two flips
+static_assert(diagnostics.loops.size() == 1);
+static_assert(diagnostics.loops[0].state == ^^Broken::Flip);
+static_assert(diagnostics.loops[0].symbol == std::meta::reflect_constant(_1));
+static_assert(diagnostics.loops[0].length == 2);
+
+// Each check can be turned off on its own
+static_assert(std::string_view(diagnostics_report<Broken>({.unreachable = false, .missing = false, .shadowed = false, .loops = false})).empty());
+
+int main() {
+	std::print("{}", diagnostics_report<Broken>());
+}
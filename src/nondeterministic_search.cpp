@@ -0,0 +1,48 @@
+#include "decl_components.hpp"
+#include "turing_machine.hpp"
+
+#include <vector>
+#include <ranges>
+#include <algorithm>
+
+enum class Symbol {
+	E,
+	_,
+	_0,
+	_1,
+	X
+};
+
+using enum Symbol;
+using enum Action;
+
+// Guesses a 1 to mark with X: on every 1 the machine either marks it and halts or moves on
+// The end of the input has no transition, so a branch which skips every 1 is rejected
+enum class [[=Config<Symbol>{"Guess", E, _}]] Search {
+	Guess [[=RL<Search,
+		{_1, X, Halt, "Guess"},
+		{_1, _1, Right, "Guess"},
+		{_0, _0, Right, "Guess"}
+	>]]
+};
+
+int main() {
+	TuringMachine<Search> tm{};
+
+	// Branches are explored breadth first, so the branch which halts first marks the leftmost 1
+	const std::vector<std::variant<Symbol>> expected{_0, _0, X, _0, _1};
+	for (unsigned threads : {1u, 4u}) {
+		auto result = tm.execute_nondeterministic({_0, _0, _1, _0, _1}, threads);
+		std::println("{} thread(s): {} after {} steps", threads, result | std::views::transform(state_variant_to_string), result.stats.steps);
+		if (!result.halted() || result.stats.steps != 3 || !std::ranges::equal(result, expected)) {
+			std::println("expected the leftmost 1 to be marked after 3 steps");
+			return 1;
+		}
+	}
+
+	auto rejected = tm.execute_nondeterministic({_0, _0, _0});
+	if (rejected.status != ExecutionStatus::Rejected) {
+		std::println("an input without a 1 should reject every branch");
+		return 1;
+	}
+}
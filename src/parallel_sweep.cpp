@@ -0,0 +1,33 @@
+#include "inverter.hpp"
+#include "turing_machine.hpp"
+
+#include <vector>
+#include <ranges>
+#include <algorithm>
+
+constexpr std::size_t passes = 3;
+constexpr std::size_t bits = std::size_t{1} << 20;
+
+int main() {
+	const auto input = inverter_input(passes, bits);
+
+	TuringMachine<Inverter> sequential{};
+	auto expected = sequential.execute(input);
+	std::println("sequential: {} steps in {}", expected.stats.steps, std::chrono::duration_cast<std::chrono::milliseconds>(expected.stats.duration));
+
+	// Small enough regions that every pass over the bits is swept in parallel
+	TuringMachine<Inverter> parallel{};
+	parallel.set_parallel_sweep(4, std::size_t{1} << 16);
+	auto result = parallel.execute(input);
+	std::println("parallel:   {} steps in {}", result.stats.steps, std::chrono::duration_cast<std::chrono::milliseconds>(result.stats.duration));
+
+	if (result.status != expected.status || result.stats.steps != expected.stats.steps || !std::ranges::equal(result, expected)) {
+		std::println("parallel sweeps diverged from sequential execution");
+		return 1;
+	}
+	// An odd number of passes leaves every bit inverted
+	if (result[passes + 1] != std::variant<Symbol>{_0} || result[passes + 2] != std::variant<Symbol>{_1}) {
+		std::println("bits were not inverted");
+		return 1;
+	}
+}
@@ -0,0 +1,65 @@
+#include "decl_components.hpp"
+#include "profile.hpp"
+
+#include <vector>
+#include <array>
+#include <ranges>
+#include <algorithm>
+#include <fstream>
+#include <cstdint>
+
+enum class Symbol {
+	E,
+	_,
+	_0,
+	_1
+};
+
+using enum Symbol;
+using enum Action;
+
+// Inverts every bit of the input
+enum class [[=Config<Symbol>{"Scan", E, _}]] Flipper {
+	Scan [[=RL<Flipper,
+		{_0, _1, Right, "Scan"},
+		{_1, _0, Right, "Scan"},
+		{E, _, Halt, "Scan"}
+	>]]
+};
+
+// Generated by running this example with the file as its argument, and checked in
+// Must be included before TuringMachine<Flipper> is instantiated
+#include "flipper_profile.hpp"
+#include "turing_machine.hpp"
+
+// The input below has 6 ones to 2 zeros, so the profile tries the _1 read first (the E read stays last)
+static_assert(std::ranges::equal(impl::response_order<Flipper, 0>, std::array<std::size_t, 3>{1, 0, 2}));
+
+int main(int argc, char** argv) {
+	const std::vector<std::variant<Symbol>> input{_1, _1, _0, _1, _1, _0, _1, _1};
+
+	TuringMachine<Flipper> tm{};
+	std::vector<std::uint64_t> hits;
+	tm.set_profile(&hits);
+	auto profiled = tm.execute(input);
+	std::println("{}", profiled | std::views::transform(state_variant_to_string));
+
+	// Pass a path to regenerate the profile, e.g. src/flipper_profile.hpp
+	if (argc > 1) {
+		std::ofstream out(argv[1]);
+		write_profile<Flipper>(out, hits);
+	}
+	if (!std::ranges::equal(hits, response_profile<Flipper>)) {
+		std::println("hit counts {} don't match the checked in profile {}", hits, response_profile<Flipper>);
+		return 1;
+	}
+
+	// Reordering the transitions must not change the result
+	TuringMachine<Flipper> ordered{};
+	auto result = ordered.execute(input);
+	const std::vector<std::variant<Symbol>> expected{_0, _0, _1, _0, _0, _1, _0, _0, E};
+	if (!result.halted() || result.stats.steps != 9 || !std::ranges::equal(result, expected)) {
+		std::println("the profile guided machine gave a different result");
+		return 1;
+	}
+}
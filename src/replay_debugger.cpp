@@ -0,0 +1,82 @@
+#include "inverter.hpp"
+#include "turing_machine.hpp"
+
+#include <vector>
+#include <map>
+#include <ranges>
+#include <algorithm>
+#include <cstdint>
+#include <string_view>
+
+constexpr std::size_t passes = 3;
+// Several chunks, so parallel sweep regions are split between workers
+constexpr std::size_t bits = std::size_t{1} << 15;
+
+struct Snapshot {
+	std::size_t head;
+	std::variant<Inverter> state;
+	std::vector<std::variant<Symbol>> tape;
+};
+
+int main() {
+	const auto input = inverter_input(passes, bits);
+	const std::size_t middle = passes + 1 + bits / 2;
+
+	// Profiling disables superinstructions and sweeps, so run(1) performs exactly one transition
+	// Configurations are kept inside superinstructions (Back and Clear are only ever entered part way through one),
+	// in the middle of each sweep over the bits, and at both ends of the run
+	TuringMachine<Inverter> reference{};
+	std::vector<std::uint64_t> hits;
+	reference.set_profile(&hits);
+	reference.load(input);
+	std::map<std::size_t, Snapshot> snapshots;
+	auto capture = [&] {
+		auto tape = reference.result();
+		snapshots[reference.steps()] = Snapshot{reference.head(), reference.state(), {tape.begin(), tape.end()}};
+	};
+	capture();
+	while (!reference.run(1)) {
+		const auto state = reference.state();
+		if (state == std::variant<Inverter>{Inverter::Back} || state == std::variant<Inverter>{Inverter::Clear}
+			|| (state == std::variant<Inverter>{Inverter::Invert} && reference.head() == middle))
+			capture();
+	}
+	capture();
+
+	// Recorded with superinstructions and parallel sweeps, with a small keyframe interval so seeking restores keyframes
+	TuringMachine<Inverter> tm{};
+	tm.enable_replay(std::size_t{1} << 12);
+	tm.set_parallel_sweep(4, std::size_t{1} << 12);
+	auto result = tm.execute(input);
+	const std::size_t total = result.stats.steps;
+	std::println("halted after {} steps, {} log bytes, {} keyframes, {} checkpoints", total, tm.replay_log()->bytes(), tm.replay_log()->keyframes(), snapshots.size());
+	if (total != reference.steps()) {
+		std::println("recorded run took {} steps, expected {}", total, reference.steps());
+		return 1;
+	}
+
+	auto check = [&](std::string_view action, std::size_t target) {
+		const Snapshot& expected = snapshots.at(target);
+		auto tape = tm.result();
+		if (tm.steps() != target || tm.head() != expected.head || tm.state() != expected.state || !std::ranges::equal(tape, expected.tape)) {
+			std::println("{} to step {} gave the wrong configuration", action, target);
+			return false;
+		}
+		return true;
+	};
+
+	// Backwards from the halted machine, then forwards again, so every seek crosses superinstructions and sweeps in both directions
+	for (const auto& [target, snapshot] : snapshots | std::views::reverse) {
+		if (!tm.seek(target) || !check("seeking back", target))
+			return 1;
+	}
+	for (const auto& [target, snapshot] : snapshots) {
+		if (!tm.seek(target) || !check("seeking forward", target))
+			return 1;
+	}
+
+	// Undo the halting transition and then redo it
+	if (!tm.step_back() || !tm.seek(total) || !check("stepping back and forward", total))
+		return 1;
+	std::println("every seek matched the reference run");
+}
@@ -0,0 +1,33 @@
+#include "decl_components.hpp"
+#include "multi_tape_turing_machine.hpp"
+
+enum class Symbol {
+	E,
+	_,
+	_0,
+	_1,
+	X
+};
+
+using enum Symbol;
+using enum Action;
+
+// Reverses the input (prefixed with an X marker) onto the second tape in a single backwards pass
+// (a single tape version has to shuttle back and forth for every symbol, see Cr0/Cr1 in unary_to_binary_skeleton.cpp)
+enum class [[=Config<Symbol>{"FindEnd", E, _, 2}]] Reverse {
+	FindEnd [[=MRL<Reverse,
+		{{E, _}, {_, _}, {Left, None}, "Copy"},
+		{{_, _}, {_, _}, {Right, None}, "FindEnd"}
+	>]],
+	Copy [[=MRL<Reverse,
+		{{_0, _}, {_, _0}, {Left, Right}, "Copy"},
+		{{_1, _}, {_, _1}, {Left, Right}, "Copy"},
+		{{X, _}, {_, _}, {Halt, Halt}, "Copy"}
+	>]]
+};
+
+int main() {
+	MultiTapeTuringMachine<Reverse> tm{};
+	std::println("{}", tm.execute({X, _1, _0, _1, _1, _0})[1] | std::views::transform(state_variant_to_string));
+	std::println("{}", tm.execute({X, _0, _0, _1})[1] | std::views::transform(state_variant_to_string));
+}
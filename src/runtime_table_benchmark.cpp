@@ -0,0 +1,74 @@
+#include "decl_components.hpp"
+#include "turing_machine.hpp"
+#include "runtime_table.hpp"
+#include "runtime_turing_machine.hpp"
+#include "counter.hpp"
+
+#include <chrono>
+#include <sstream>
+
+// The same machine written as a text table
+constexpr std::string_view counterText = R"(
+; Counts up in binary until the counter overflows into the X marker
+start ToEnd
+blank E
+ToEnd     E   L      Increment
+ToEnd     *   R      ToEnd
+Increment _1  P_0,L  Increment
+Increment _0  P_1,R  ToEnd
+Increment X   H      Increment
+)";
+
+constexpr std::size_t width = 20;
+// Target for the exported table, not yet a measured figure, the printed ratio is what to tune it against
+constexpr double maxSlowdown = 1.5;
+
+auto benchmark(std::string_view name, auto run) {
+	ExecutionStats stats = run();
+	std::chrono::duration<double> elapsed = stats.duration;
+	double rate = stats.steps / elapsed.count();
+	std::println("{:<24} {:>12} steps {:>10.3f}s {:>14.0f} steps/s {:>10} tape bytes", name, stats.steps, elapsed.count(), rate, stats.tapeBytes);
+	return rate;
+}
+
+int main() {
+	const std::vector<std::variant<Symbol>> input = counter_input(width);
+
+	TuringMachine<Counter> tm{};
+	double compiled = benchmark("compile time table", [&] {
+		return tm.execute(input).stats;
+	});
+
+	// Round trip the exported table through the binary format
+	std::stringstream binary;
+	write_table(binary, export_table<Counter>());
+	RuntimeTuringMachine exported{read_table(binary)};
+	std::vector<std::uint16_t> exportedInput{*exported.table().symbol_id("X")};
+	exportedInput.resize(width + 1, *exported.table().symbol_id("_0"));
+	double loaded = benchmark("exported table", [&] {
+		return exported.execute(exportedInput).stats;
+	});
+
+	// The counter is small enough that a dense table is chosen, force the sparse layouts for comparison
+	for (auto [name, layout] : {std::pair{"compressed table", TableLayout::Compressed}, std::pair{"hashed table", TableLayout::Hashed}}) {
+		RuntimeTuringMachine sparse{export_table<Counter>(), layout};
+		benchmark(name, [&] {
+			return sparse.execute(exportedInput).stats;
+		});
+	}
+
+	RuntimeTuringMachine parsed{parse_table(counterText)};
+	std::vector<std::uint16_t> parsedInput{*parsed.table().symbol_id("X")};
+	parsedInput.resize(width + 1, *parsed.table().symbol_id("_0"));
+	benchmark("parsed text table", [&] {
+		return parsed.execute(parsedInput).stats;
+	});
+
+	// Runtime tables must stay within 1.5x of the compiled machine's throughput
+	const double ratio = loaded / compiled;
+	std::println("runtime / compile time steps/s: {:.2f}", ratio);
+	if (ratio < 1 / maxSlowdown) {
+		std::println("exported table is more than {}x slower than the compiled machine", maxSlowdown);
+		return 1;
+	}
+}
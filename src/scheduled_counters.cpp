@@ -0,0 +1,43 @@
+#include "decl_components.hpp"
+#include "turing_machine.hpp"
+#include "scheduler.hpp"
+#include "counter.hpp"
+
+#include <array>
+#include <vector>
+#include <string>
+#include <utility>
+#include <format>
+#include <iostream>
+#include <future>
+
+constexpr std::size_t jobs = 8;
+constexpr std::size_t quantum = 1 << 16;
+
+int main() {
+	// More jobs than workers, each job runs a quantum at a time
+	Scheduler scheduler{2};
+
+	std::array<TuringMachine<Counter>, jobs> machines;
+	std::array<std::future<void>, jobs> done;
+	for (std::size_t i = 0; i < jobs; ++i) {
+		machines[i].load(counter_input(11 + i));
+		// Even jobs receive twice the share of the workers
+		done[i] = scheduler.submit(execute_sliced(machines[i], quantum), i % 2 == 0 ? 2 : 1);
+	}
+
+	std::vector<std::pair<std::string, ExecutionStats>> stats;
+	for (std::size_t i = 0; i < jobs; ++i) {
+		done[i].get();
+		auto result = machines[i].result();
+		std::println("counter {}: {} steps in {}", i, result.stats.steps, std::chrono::duration_cast<std::chrono::microseconds>(result.stats.duration));
+		stats.emplace_back(std::format("counter_{}", i), result.stats);
+	}
+
+	// Every job in one exposition, as a scraper would read it
+	write_prometheus(std::cout, stats);
+	for (const auto& [job, jobStats] : stats) {
+		std::print("{}: ", job);
+		write_json(std::cout, jobStats);
+	}
+}
@@ -0,0 +1,196 @@
+#include "decl_components.hpp"
+#include "turing_machine.hpp"
+
+enum class Symbol {
+	E,
+	_,
+	_0,
+	_1,
+	X,
+	Y,
+	Z,
+	C
+};
+
+using enum Symbol;
+using enum Action;
+
+// Single exit skeleton tables are concrete and return through the call stack (RCall/Ret),
+// so each is only instantiated once however many places call it
+
+// Return to start of string
+enum class [[=Config<Symbol>{"Start", E, _}]] St {
+	Start [[=RL<St,
+		{X, _, Right, Ret},
+		{_, _, Left, "Start"}
+	>]]
+};
+
+// Find first 0 or Y
+template <StateRef s0, StateRef sY>
+struct Ff {
+	enum [[=Config<Symbol>{"ReturnToStart", E, _}]] State {
+		ReturnToStart [[=RL<State,
+			{_, _, None, RCall<St, "ScanRight">}
+		>]],
+		ScanRight [[=RL<State,
+			{_0, _, None, s0},
+			{Y, _, None, sY},
+			{_, _, Right, "ScanRight"}
+		>]]
+	};
+};
+
+// Find next 0 or Y
+template <StateRef s0, StateRef sY>
+struct Fn {
+	enum [[=Config<Symbol>{"ScanRight", E, _}]] State {
+		ScanRight [[=RL<State,
+			{_0, _, None, s0},
+			{Y, _, None, sY},
+			{_, _, Right, "ScanRight"}
+		>]]
+	};
+};
+
+// Find end of string (Z)
+enum class [[=Config<Symbol>{"ScanRight", E, _}]] End {
+	ScanRight [[=RL<End,
+		{Z, _, None, Ret},
+		{_, _, Right, "ScanRight"}
+	>]]
+};
+
+// Write 1
+enum class [[=Config<Symbol>{"FindEnd", E, _}]] W1 {
+	FindEnd [[=RL<W1,
+		{_, _, None, RCall<End, "Write1">}
+	>]],
+	Write1 [[=RL<W1,
+		{Z, _1, Right, "WriteZ"}
+	>]],
+	WriteZ [[=RL<W1,
+		{_, Z, None, Ret}
+	>]]
+};
+
+// Write 0
+enum class [[=Config<Symbol>{"FindEnd", E, _}]] W0 {
+	FindEnd [[=RL<W0,
+		{_, _, None, RCall<End, "Write0">}
+	>]],
+	Write0 [[=RL<W0,
+		{Z, _0, Right, "WriteZ"}
+	>]],
+	WriteZ [[=RL<W0,
+		{_, Z, None, Ret}
+	>]]
+};
+
+// Copy 0 and return
+enum class [[=Config<Symbol>{"WriteZ", E, _}]] Cr0 {
+	WriteZ [[=RL<Cr0,
+		{_0, Z, None, "Copy"}
+	>]],
+	Copy [[=RL<Cr0,
+		{C, _0, Right, "WriteC"},
+		{X, _0, Right, "WriteC"},
+		{_, _, Left, "Copy"}
+	>]],
+	// Tail call, End returns straight to our caller
+	WriteC [[=RL<Cr0,
+		{_, C, None, CCall<End>}
+	>]]
+};
+
+// Copy 1 and return
+enum class [[=Config<Symbol>{"WriteZ", E, _}]] Cr1 {
+	WriteZ [[=RL<Cr1,
+		{_1, Z, None, "Copy"}
+	>]],
+	Copy [[=RL<Cr1,
+		{C, _1, Right, "WriteC"},
+		{X, _1, Right, "WriteC"},
+		{_, _, Left, "Copy"}
+	>]],
+	WriteC [[=RL<Cr1,
+		{_, C, None, CCall<End>}
+	>]]
+};
+
+// Find C in reverse
+enum class [[=Config<Symbol>{"ScanLeft", E, _}]] Fcr {
+	ScanLeft [[=RL<Fcr,
+		{C, _, None, Ret},
+		{_, _, Left, "ScanLeft"}
+	>]]
+};
+
+// Terminate
+enum class [[=Config<Symbol>{"FindEnd", E, _}]] Term {
+	FindEnd [[=RL<Term,
+		{_, _, None, RCall<End, "Copy">}
+	>]],
+	Copy [[=RL<Term,
+		{Y, _, None, RCall<Fcr, "Overwrite">},
+		{_0, _, None, RCall<Cr0, "Copy">},
+		{_1, _, None, RCall<Cr1, "Copy">},
+		{Z, _, Left, "Copy"}
+	>]],
+	Overwrite [[=RL<Term,
+		{Z, E, Right, "End"},
+		{_, E, Right, "Overwrite"}
+	>]],
+	End [[=RL<Term,
+		{E, _, Halt, "End"},
+		{_, E, Right, "End"}
+	>]]
+};
+
+// Halt [Do nothing forever]
+enum class [[=Config<Symbol>{"End", E, _}]] Sink {
+	End [[=RL<Sink,
+		{_, _, Halt, "End"}
+	>]]
+};
+
+enum class [[=Config<Symbol>{"Prelude0", E, _}]] Main {
+	// Prelude
+	Prelude0 [[=RL<Main,
+		{_0, X, Right, "Prelude1"},
+		{E, _0, None, CCall<Sink>}
+	>]],
+	Prelude1 [[=RL<Main,
+		{_0, _, Right, "Prelude1"},
+		{E, _0, Right, "Prelude2_0"}
+	>]],
+	Prelude2_0 [[=RL<Main,
+		{_, Y, Right, "Prelude2_1"}
+	>]],
+	Prelude2_1 [[=RL<Main,
+		{_, Z, None, "Step1"}
+	>]],
+	// Step 1
+	Step1 [[=RL<Main,
+		{_, _, None, Call<Ff, "Step23", CCall<Term>>}
+	>]],
+	// Step 2 and 3
+	Step23 [[=RL<Main,
+		{_0, E, None, Call<Fn, "Step4", "Write1">}
+	>]],
+	// Step 4
+	Step4 [[=RL<Main,
+		{_0, _, Right, Call<Fn, "Step23", "Write0">}
+	>]],
+	Write1 [[=RL<Main,
+		{_, _, None, RCall<W1, "Step1">}
+	>]],
+	Write0 [[=RL<Main,
+		{_, _, None, RCall<W0, "Step1">}
+	>]]
+};
+
+int main() {
+	TuringMachine<Main> tm{};
+	std::println("{}", tm.execute({_0, _0, _0, _0, _0}) | std::views::transform(state_variant_to_string));
+}